@@ -2,6 +2,8 @@
 #include "problems/connect4/problem.h"
 #include "rlop/minmax/alpha_beta_search_trans.h"
 #include "rlop/minmax/transpositions.h"
+#include "rlop/minmax/lazy_smp_search.h"
+#include "opening_book.h"
 
 namespace connect4 {
     class AlphaBetaSearch : public rlop::AlphaBetaSearchTrans<Board::bitboard> {
@@ -9,24 +11,51 @@ namespace connect4 {
         static constexpr Int kTransSize = 8306069;
         static constexpr Int kSymmetryThres = 10;
         static constexpr double kWinScore = 1;
+        static constexpr double kMateStep = 1.0 / 64;
 
-        AlphaBetaSearch() : rlop::AlphaBetaSearchTrans<Board::bitboard>(kWinScore), transposition_(kTransSize) {}
+        using Transposition = rlop::BucketTransposition<Board::bitboard>;
+
+        // Constructs an AlphaBetaSearch with its own transposition table, or with a table shared with other searches.
+        //
+        // Parameters:
+        //   transposition: The table to share. Default is nullptr, i.e., a new table is created.
+        AlphaBetaSearch(std::shared_ptr<Transposition> transposition = nullptr) : 
+            rlop::AlphaBetaSearchTrans<Board::bitboard>(kWinScore, Board::kWidth_), 
+            transposition_(transposition? std::move(transposition) : std::make_shared<Transposition>(kTransSize)) 
+        {
+            set_mode(SearchMode::kPVS);
+            set_move_ordering(true);
+        }
+
+        // Scores the wins and the losses by the number of plies to them, so that the search returns the fastest win, at
+        // the cost of more nodes than proving the result of the game only.
+        void EnableMateScoring() {
+            set_mate_scoring(kMateStep, Board::kSize_);
+        }
 
         void Reset() override {
+            rlop::AlphaBetaSearchTrans<Board::bitboard>::Reset();
             problem_.Reset();
-            transposition_.Reset();
+            transposition_->Reset();
             ResetPriorScores();
         }
 
         void Reset(const Board& board) {
-            problem_.Reset(board);
-            transposition_.Reset();
-            ResetPriorScores();
+            Load(board);
+            transposition_->Reset();
         } 
 
         void Reset(Board&& board) {
+            rlop::AlphaBetaSearchTrans<Board::bitboard>::Reset();
             problem_.Reset(std::move(board));
-            transposition_.Reset();
+            transposition_->Reset();
+            ResetPriorScores();
+        }
+
+        // Resets the search to a position, keeping the transposition table, which may be shared with other searches.
+        void Load(const Board& board) {
+            rlop::AlphaBetaSearchTrans<Board::bitboard>::Reset();
+            problem_.Reset(board);
             ResetPriorScores();
         }
 
@@ -57,15 +86,17 @@ namespace connect4 {
         }
 
         Board::bitboard PositionEncode() override {
-            Board::bitboard code = problem_.board().PositionEncode();
-            if (problem_.board().num_moves() < kSymmetryThres) {
-                Board::bitboard rev = 0; 
-                for (auto tmp = code; tmp != 0; tmp >>= Board::kH1_) {
-                    rev = (rev << Board::kH1_) | (tmp & Board::kCol1_);
-                }
-                if (rev < code)
-                    code = rev;
-            }
+            return Canonicalize(problem_.board().PositionEncode(), problem_.board().num_moves());
+        }
+
+        // Returns the code of a position or of its mirror, whichever is smaller, if the position is in the opening.
+        //
+        // Parameters:
+        //   code: The code of the position.
+        //   num_moves: The number of moves played in the position.
+        static Board::bitboard Canonicalize(Board::bitboard code, Int num_moves) {
+            if (num_moves < kSymmetryThres)
+                code = std::min(code, Board::MirrorEncode(code));
             return code;
         }
         
@@ -73,23 +104,41 @@ namespace connect4 {
             return prior_scores_[problem_.board().heights()[move]][move];
         }
 
-        std::vector<Int> GenerateMoves() override {
-            std::vector<Int> moves;
-            moves.reserve(problem_.NumMoves());
+        // Keys a move by the cell it lands on, since dropping a disc into the same column means different things at
+        // different heights.
+        Int MoveKey(Int move) override {
+            return move * Board::kH1_ + problem_.board().heights()[move];
+        }
+
+        // Scores the killer moves the highest, followed by the other moves in the order of their prior scores, whose
+        // ties are broken by the history scores.
+        Int MoveScore(Int move, Int ply) override {
+            Int key = MoveKey(move);
+            Int slot = killers_.Find(ply, key);
+            if (slot != kIntNull)
+                return kIntFull - slot;
+            return (GetPriorScore(move) << 32) + std::min(history_.Get(ply & 1, key), Int(0xFFFFFFFF));
+        }
+
+        // Generates the playable moves, or only a winning move if there is one, which is found on the bitboards without
+        // making any move. The transposition table bucket of each child position is prefetched at that time, well before
+        // the child is searched and probes the table.
+        void GenerateMoves(rlop::MoveList* moves) override {
+            const Board& board = problem_.board();
+            Board::bitboard winning = board.WinningCells();
             for (Int i=0; i<problem_.NumMoves(); ++i) {
                 Int move = problem_.GetMove(i);
-                if (problem_.Step(move)) {
-                    if (problem_.board().Win()) {
-                        problem_.Undo(move);
-                        moves = { move };
-                        break;
-                    }
-                    problem_.Undo(move);
-                    moves.push_back(move);
+                if (!board.IsPlayable(move))
+                    continue;
+                if (winning & Board::ColumnMask(move)) {
+                    moves->clear();
+                    moves->push_back(move);
+                    return;
                 }
+                transposition_->Prefetch(Canonicalize(board.PositionEncode(move), board.num_moves() + 1));
+                moves->push_back(move);
             }
-            std::sort(moves.begin(), moves.end(), [this](Int mv1, Int mv2){ return this->GetPriorScore(mv1) > this->GetPriorScore(mv2);});
-            return moves;
+            std::sort(moves->begin(), moves->end(), [this](Int mv1, Int mv2){ return this->GetPriorScore(mv1) > this->GetPriorScore(mv2);});
         }
 
         bool MakeMove(Int move) override {
@@ -100,35 +149,184 @@ namespace connect4 {
             problem_.Undo(move);
         }
 
+        // Looks up the opening book first, whose values are exact at any depth, and then the transposition table. The book
+        // is skipped with mate scoring, as its values carry no distances.
         std::optional<std::pair<double, ValueType>> Transpose(const Board::bitboard& key, Int depth) override {
-            const auto& item = transposition_.Get(key);
+            if (book_ && mate_step_ <= 0) {
+                auto entry = book_->Probe(problem_.board());
+                if (entry)
+                    return std::pair<double, ValueType>{ entry->second * kWinScore, ValueType::kExact };
+            }
+            auto item = transposition_->Get(key);
             if (item.lock == key && item.depth >= depth) 
                 return std::pair<double, ValueType>{ item.value, item.type };
             return std::nullopt;
         }
 
         void UpdateTable(const Board::bitboard& key, Int depth, double value, ValueType type) override {
-            const auto& item = transposition_.Get(key);
-            if (item.type == ValueType::kNone || depth > item.depth)
-                transposition_.Save(key, { key, depth, value, type });
+            UpdateTable(key, depth, value, type, kIntNull);
         }
 
-        auto NewSearch(const Board& board, Int depth = kIntFull) {
-            Reset(board);
-            auto [mv, value] = Search(depth);
-            if (mv == kIntNull) {
-                for (Int i=0; i<problem_.NumMoves(); ++i) {
-                    Int mv = problem_.GetMove(i);
-                    if (problem_.board().IsPlayable(mv))
-                        return mv;
-                }
+        // Saves an item, leaving the choice of the entry to the replacement policy of the table. The move is saved for
+        // the position of the key, i.e., mirrored if the key is the code of the mirror image of the current position.
+        void UpdateTable(const Board::bitboard& key, Int depth, double value, ValueType type, Int move) override {
+            transposition_->Save(key, { key, depth, value, type, MirrorMove(key, move) });
+        }
+
+        Int GetBestMove(const Board::bitboard& key) override {
+            auto item = transposition_->Get(key);
+            return item.lock == key? MirrorMove(key, item.move) : kIntNull;
+        }
+
+        // Mirrors a move between the current position and the position of its key, if the key is the code of the mirror
+        // image, as OpeningBook does for its moves.
+        Int MirrorMove(const Board::bitboard& key, Int move) const {
+            if (move == kIntNull || key == problem_.board().PositionEncode())
+                return move;
+            return Board::kWidth_ - 1 - move;
+        }
+
+        // Searches the best move of a position. The transposition table is kept from the previous searches, whose items
+        // are aged by a new generation.
+        //
+        // Parameters:
+        //   board: The position to search.
+        //   depth: The maximum depth. Default is kIntFull, i.e., solving the position.
+        //   time_limit: The time limit in milliseconds. If it is set, the position is searched by iterative deepening
+        //               and the best move of the deepest completed iteration is returned.
+        auto NewSearch(const Board& board, Int depth = kIntFull, int64_t time_limit = kIntFull) {
+            Load(board);
+            Int book_move = BookMove(board);
+            if (book_move != kIntNull)
+                return book_move;
+            transposition_->NewGeneration();
+            std::pair<Int, double> result;
+            if (time_limit != kIntFull)
+                result = IterativeSearch(std::min(depth, Int(Board::kSize_ - board.num_moves())), time_limit);
+            else if (mtd_)
+                result = MTDSearch(depth);
+            else
+                result = Search(depth);
+            return result.first == kIntNull? FirstPlayableMove() : result.first;
+        }
+
+        bool mtd() const {
+            return mtd_;
+        }
+
+        // Sets whether NewSearch() without a time limit solves by MTDSearch() instead of Search(), starting from a draw.
+        void set_mtd(bool mtd) {
+            mtd_ = mtd;
+        }
+
+        // Returns the best move of a position in the opening book, or kIntNull if the position is not in the book, its
+        // move is not playable or mate scoring is enabled.
+        Int BookMove(const Board& board) const {
+            if (!book_ || mate_step_ > 0)
+                return kIntNull;
+            auto entry = book_->Probe(board);
+            if (!entry || entry->first < 0 || entry->first >= Board::kWidth_ || !board.IsPlayable(entry->first))
+                return kIntNull;
+            return entry->first;
+        }
+
+        const std::shared_ptr<const OpeningBook>& book() const {
+            return book_;
+        }
+
+        // Sets the opening book probed by the search, which may be shared with other searches. nullptr disables it.
+        void set_book(std::shared_ptr<const OpeningBook> book) {
+            book_ = std::move(book);
+        }
+
+        // Returns the first playable move of the current position, or kIntNull if the board is full.
+        Int FirstPlayableMove() const {
+            for (Int i=0; i<problem_.NumMoves(); ++i) {
+                Int mv = problem_.GetMove(i);
+                if (problem_.board().IsPlayable(mv))
+                    return mv;
             }
-            return mv;
+            return kIntNull;
         }
 
     protected:
         Problem problem_;
-        rlop::CircularTransposition<Board::bitboard> transposition_;
+        std::shared_ptr<Transposition> transposition_;
+        std::shared_ptr<const OpeningBook> book_;
+        bool mtd_ = false;
         std::vector<std::vector<Int>> prior_scores_;
     };
+
+    // Solves positions by Lazy SMP, in which each thread owns an AlphaBetaSearch and all of them share a transposition
+    // table.
+    class ParallelAlphaBetaSearch : public rlop::LazySMPSearch<AlphaBetaSearch> {
+    public:
+        // Constructs a ParallelAlphaBetaSearch with a number of threads.
+        //
+        // Parameters:
+        //   num_threads: The number of threads.
+        ParallelAlphaBetaSearch(Int num_threads) : 
+            transposition_(std::make_shared<AlphaBetaSearch::Transposition>(AlphaBetaSearch::kTransSize)) 
+        {
+            for (Int i=0; i<num_threads; ++i) {
+                searches_.push_back(std::make_unique<AlphaBetaSearch>(transposition_));
+            }
+        }
+
+        void Reset() override {
+            Board board;
+            board.Reset();
+            Reset(board);
+        }
+
+        void Reset(const Board& board) {
+            for (auto& search : searches_) {
+                search->Load(board);
+            }
+            winner_ = kIntNull;
+            transposition_->Reset();
+        }
+
+        void set_mode(AlphaBetaSearch::SearchMode mode) {
+            for (auto& search : searches_) {
+                search->set_mode(mode);
+            }
+        }
+
+        void set_book(const std::shared_ptr<const OpeningBook>& book) {
+            for (auto& search : searches_) {
+                search->set_book(book);
+            }
+        }
+
+        // Searches the best move of a position in parallel. See AlphaBetaSearch::NewSearch().
+        auto NewSearch(const Board& board, Int depth = kIntFull, int64_t time_limit = kIntFull) {
+            for (auto& search : searches_) {
+                search->Load(board);
+            }
+            Int book_move = searches_[0]->BookMove(board);
+            if (book_move != kIntNull)
+                return book_move;
+            transposition_->NewGeneration();
+            auto [mv, value] = time_limit == kIntFull? Search(depth) : IterativeSearch(std::min(depth, Int(Board::kSize_ - board.num_moves())), time_limit);
+            return mv == kIntNull? searches_[0]->FirstPlayableMove() : mv;
+        }
+
+        // Solves a position in parallel, keeping the transposition table from the previous searches.
+        //
+        // Returns:
+        //   std::pair<Int, double>: The best move and the value of the position, kWinScore for a win of the side to move.
+        //                           The move of a lost position, which no move improves, is its first playable move.
+        std::pair<Int, double> Solve(const Board& board) {
+            for (auto& search : searches_) {
+                search->Load(board);
+            }
+            transposition_->NewGeneration();
+            auto [mv, value] = Search(kIntFull);
+            return { mv == kIntNull? searches_[0]->FirstPlayableMove() : mv, value };
+        }
+
+    protected:
+        std::shared_ptr<AlphaBetaSearch::Transposition> transposition_;
+    };
 }
\ No newline at end of file
@@ -0,0 +1,44 @@
+#ifdef CONNECT4_TORCH
+#include "torch_batched_puct.h"
+#else
+#include "batched_puct.h"
+#endif
+#include "rlop/common/timer.h"
+
+// Runs the batched PUCT search from the initial position and from a position in which the player to move has to block
+// a horizontal three in column 3, for each batch size. Without CONNECT4_TORCH, the leaves are evaluated by random
+// playouts; with it, by a tiny libtorch model.
+//
+// Usage: connect4_batched_puct [num_iters]
+int main(int argc, char *argv[]) {
+    using namespace connect4;
+#ifdef CONNECT4_TORCH
+    using Solver = TorchBatchedPUCT;
+#else
+    using Solver = BatchedPUCT;
+#endif
+
+    Int num_iters = argc > 1? std::stoi(argv[1]) : 20000;
+    rlop::Timer timer;
+
+    Board initial;
+    initial.Reset();
+    Board block;
+    block.Reset();
+    for (int col : { 0, 6, 1, 6, 2 })
+        block.MakeMove(col);
+
+    for (const Board* board : { &initial, &block }) {
+        board->Print();
+        for (Int batch_size : { 1, 8, 32 }) {
+            Solver solver(batch_size);
+            timer.Restart();
+            Int move = solver.NewSearch(*board, num_iters);
+            timer.Stop();
+            std::cout << "batch size: " << batch_size << ", move: " << move << ", duration: " << timer.duration()
+                << "ms, leaves per second: " << num_iters * 1000 / std::max(timer.duration(), int64_t(1)) << std::endl;
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include "problems/connect4/problem.h"
+#include "rlop/mcts/batched_puct.h"
+#include "rlop/common/random.h"
+
+namespace connect4 {
+    // Implements the game of a batched PUCT search from a root position, in which the children of a node are the
+    // playable columns of its position in ascending order. The rewards and the values are from the perspective of the
+    // player to move at the root, and each node keeps them from the perspective of the player choosing it.
+    //
+    // Template parameters:
+    //   TBase: rlop::BatchedPUCT or a subclass of it, e.g., rlop::TorchBatchedPUCT.
+    template<typename TBase>
+    class BatchedPUCTBase : public TBase {
+    public:
+        using TBase::TBase;
+
+        Int NumChildStates() const override {
+            Int num_children = 0;
+            for (int col=0; col<Board::kWidth_; ++col) {
+                num_children += board_.IsPlayable(col);
+            }
+            return num_children;
+        }
+
+        void RevertState() override {
+            board_ = root_board_;
+        }
+
+        bool Step(Int child_i) override {
+            board_.MakeMove(GetMove(board_, child_i));
+            return !board_.IsOver();
+        }
+
+        // Returns 1 if the player to move at the root has won, -1 if the opponent has won, and 0 for a draw.
+        double Reward() override {
+            if (!board_.Win())
+                return 0;
+            return Depth() % 2 == 1? 1 : -1;
+        }
+
+        void UpdateNode(typename TBase::Node* node, Int depth, double reward) const override {
+            TBase::UpdateNode(node, depth, depth % 2 == 1? reward : -reward);
+        }
+
+        // Searches a position that is not over.
+        //
+        // Returns:
+        //   Int: The column of the most visited child of the root.
+        Int NewSearch(const Board& board, Int max_num_iters) {
+            root_board_ = board;
+            this->Reset();
+            this->Search(max_num_iters);
+            auto child_i = this->SelectMostVisited();
+            return child_i? GetMove(root_board_, *child_i) : kIntNull;
+        }
+
+        // Returns the column of a child of a position.
+        static Int GetMove(const Board& board, Int child_i) {
+            for (int col=0; col<Board::kWidth_; ++col) {
+                if (board.IsPlayable(col) && child_i-- == 0)
+                    return col;
+            }
+            return kIntNull;
+        }
+
+    protected:
+        // Returns the number of moves from the root to the current position.
+        Int Depth() const {
+            return board_.num_moves() - root_board_.num_moves();
+        }
+
+        Board root_board_;
+        Board board_;
+    };
+
+    // Evaluates the pending leaves without a model, by uniform priors and the result of a random playout of each leaf,
+    // which runs the batching of the search on any machine, e.g., to compare the batch sizes.
+    class BatchedPUCT : public BatchedPUCTBase<rlop::BatchedPUCT> {
+    public:
+        using BatchedPUCTBase<rlop::BatchedPUCT>::BatchedPUCTBase;
+
+        void ObserveLeaf(Int leaf_i) override {
+            leaves_.resize(leaf_i + 1);
+            leaves_[leaf_i] = { board_, Depth() };
+        }
+
+        void PredictLeaves(Int num_leaves, std::vector<float>* priors, std::vector<float>* values) override {
+            priors->assign(num_leaves * Board::kWidth_, 0);
+            values->resize(num_leaves);
+            for (Int i=0; i<num_leaves; ++i) {
+                auto [board, depth] = leaves_[i];
+                Int num_children = 0;
+                for (int col=0; col<Board::kWidth_; ++col) {
+                    num_children += board.IsPlayable(col);
+                }
+                for (Int j=0; j<num_children; ++j) {
+                    (*priors)[i * Board::kWidth_ + j] = 1.0f / num_children;
+                }
+                // Plays random playable columns, and scores the result for the player to move at the leaf.
+                Int player = board.num_moves() % 2;
+                while (!board.IsOver()) {
+                    Int col;
+                    do {
+                        col = rand_.UniformIndex(Board::kWidth_);
+                    } while (!board.IsPlayable(col));
+                    board.MakeMove(col);
+                }
+                double value = board.Win()? ((board.num_moves() - 1) % 2 == player? 1 : -1) : 0;
+                (*values)[i] = depth % 2 == 0? value : -value;
+            }
+        }
+
+    protected:
+        std::vector<std::pair<Board, Int>> leaves_;
+        rlop::Random rand_;
+    };
+}
@@ -0,0 +1,69 @@
+#include "alpha_beta_search.h"
+#include "rlop/common/timer.h"
+
+// Builds an opening book of the positions up to a number of plies, reachable from the initial position or from a given
+// root position, e.g., to tabulate the lines of an endgame. The positions of each ply are solved by the parallel solver
+// from the deepest ply to the root, so that the solver probes the positions already in the book.
+int main(int argc, char *argv[]) {
+    using namespace connect4;
+
+    if (argc <= 2) {
+        std::cout << "usage: connect4_book book.bin max_plies [threads] [root position]" << std::endl;
+        return 1;
+    }
+    std::string path = argv[1];
+    Int max_plies = std::stoi(argv[2]);
+    Int num_threads = argc > 3? std::stoi(argv[3]) : 1;
+#ifdef _OPENMP
+    if (argc <= 3)
+        num_threads = omp_get_max_threads();
+#endif
+
+    // Enumerates the positions of each ply that are not over, one per mirror pair.
+    Board board;
+    board.Reset();
+    if (argc > 4)
+        board.Reset(argv[4]);
+    if (board.IsOver() || board.num_moves() > max_plies) {
+        std::cout << "the root position is over or beyond max_plies" << std::endl;
+        return 1;
+    }
+    std::vector<std::vector<Board>> plies(max_plies + 1);
+    std::unordered_set<Board::bitboard> visited;
+    plies[board.num_moves()].push_back(board);
+    for (Int ply=board.num_moves(); ply<max_plies; ++ply) {
+        for (const Board& parent : plies[ply]) {
+            for (int col=0; col<Board::kWidth_; ++col) {
+                Board child = parent;
+                if (!child.MakeMove(col) || child.IsOver())
+                    continue;
+                Board::bitboard code = child.PositionEncode();
+                if (visited.insert(std::min(code, Board::MirrorEncode(code))).second)
+                    plies[ply + 1].push_back(child);
+            }
+        }
+    }
+
+    auto book = std::make_shared<OpeningBook>();
+    ParallelAlphaBetaSearch solver(num_threads);
+    solver.Reset();
+    solver.set_book(book);
+    rlop::Timer timer;
+    for (Int ply=max_plies; ply>=board.num_moves(); --ply) {
+        timer.Restart();
+        std::vector<std::pair<Int, Int>> results;
+        for (const Board& position : plies[ply]) {
+            auto [mv, value] = solver.Solve(position);
+            results.push_back({ mv, static_cast<Int>(std::round(value / AlphaBetaSearch::kWinScore)) });
+        }
+        book->Add(plies[ply], results);
+        timer.Stop();
+        std::cout << "ply " << ply << ": " << plies[ply].size() << " positions solved in duration: " << timer.duration() << std::endl;
+    }
+    if (!book->Save(path)) {
+        std::cout << "failed to save " << path << std::endl;
+        return 1;
+    }
+    std::cout << "saved " << book->size() << " positions to " << path << std::endl;
+    return 0;
+}
\ No newline at end of file
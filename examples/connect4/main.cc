@@ -9,9 +9,29 @@ int main(int argc, char *argv[]) {
    
     Board board;
     board.Reset();
+
+    // Maps an opening book given as book=<path> among the arguments after the positions file.
+    auto book = std::make_shared<OpeningBook>();
+    for (int i=3; i<argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("book=", 0) == 0 && !book->Load(arg.substr(5))) {
+            std::cout << "failed to load " << arg.substr(5) << std::endl;
+            return 1;
+        }
+    }
    
     if (argc <= 1 || std::string(argv[1]) == "alpha_beta") {
         AlphaBetaSearch solver;
+        if (book->size() > 0)
+            solver.set_book(book);
+        for (int i=3; i<argc; ++i) {
+            if (std::string(argv[i]) == "full_window")
+                solver.set_mode(rlop::AlphaBetaSearch::SearchMode::kAlphaBeta);
+            else if (std::string(argv[i]) == "mate")
+                solver.EnableMateScoring();
+            else if (std::string(argv[i]) == "mtd")
+                solver.set_mtd(true);
+        }
         std::ifstream input(argv[2]);
         std::string position;
         while(getline(input, position)) {                                            
@@ -23,7 +43,31 @@ int main(int argc, char *argv[]) {
             board.MakeMove(solver.NewSearch(board));
             timer.Stop();
             board.Print();
-            std::cout << "Solved in duration: " << timer.duration() << std::endl;
+            std::cout << "Solved in duration: " << timer.duration() << ", nodes: " << solver.num_nodes() << std::endl;
+        }
+    }
+    else if (std::string(argv[1]) == "lazy_smp") {
+        bool has_threads = argc > 3 && std::string(argv[3]).rfind("book=", 0) != 0;
+        Int num_threads = has_threads? std::stoi(argv[3]) : 1;
+#ifdef _OPENMP
+        if (!has_threads)
+            num_threads = omp_get_max_threads();
+#endif
+        ParallelAlphaBetaSearch solver(num_threads);
+        if (book->size() > 0)
+            solver.set_book(book);
+        std::ifstream input(argv[2]);
+        std::string position;
+        while(getline(input, position)) {
+            std::cout << "Solving position with " << num_threads << " threads:" << std::endl;
+            board.Reset(position);
+            board.Print();
+            solver.Reset();
+            timer.Restart();
+            board.MakeMove(solver.NewSearch(board));
+            timer.Stop();
+            board.Print();
+            std::cout << "Solved in duration: " << timer.duration() << ", nodes: " << solver.num_nodes() << std::endl;
         }
     }
     else if (std::string(argv[1]) == "mcts") {
@@ -39,10 +83,15 @@ int main(int argc, char *argv[]) {
         Int player = input == "X"? 0 : 1;
         board.Print();
         Int move;
+        Int last_move = kIntNull;
         while(!board.IsFull() && !board.Win()) {
             if (board.num_moves() % 2 == player) {
                 timer.Restart();
-                board.MakeMove(solver.NewSearch(board));
+                if (last_move == kIntNull)
+                    last_move = solver.NewSearch(board);
+                else
+                    last_move = solver.ContinueSearch(board, last_move, move);
+                board.MakeMove(last_move);
                 timer.Stop();
                 std::cout << "duration: " << timer.duration() << std::endl;
             }
@@ -73,5 +122,68 @@ int main(int argc, char *argv[]) {
             std::cout << "drawn" << std::endl;
 
     }
+    else if (std::string(argv[1]) == "mcts_benchmark") {
+        rlop::Timer<std::chrono::microseconds> us_timer;
+        Int max_num_iters = 42000;
+        for (Int num_threads : { 1, 2, 4, 8, 16, 32 }) {
+#ifdef _OPENMP
+            omp_set_num_threads(num_threads);
+#endif
+            MCTS root_parallel;
+            us_timer.Restart();
+            root_parallel.NewSearch(board, max_num_iters / Board::kWidth_);
+            us_timer.Stop();
+            double root_parallel_speed = max_num_iters * 1e6 / us_timer.duration();
+
+            TreeParallelMCTS tree_parallel(num_threads);
+            us_timer.Restart();
+            tree_parallel.NewSearch(board, max_num_iters);
+            us_timer.Stop();
+            double tree_parallel_speed = max_num_iters * 1e6 / us_timer.duration();
+
+            // The root-parallel search runs one env per move of the root, so it uses at most Board::kWidth_ threads.
+            std::cout << "threads: " << num_threads 
+                << ", root parallel threads: " << std::min(num_threads, root_parallel.num_envs())
+                << ", root parallel playouts/sec: " << root_parallel_speed
+                << ", tree parallel playouts/sec: " << tree_parallel_speed
+                << ", tree parallel nodes: " << tree_parallel.num_nodes() << std::endl;
+        }
+        for (bool transposition : { false, true }) {
+            MCTS root_parallel;
+            root_parallel.set_transposition(transposition);
+            us_timer.Restart();
+            root_parallel.NewSearch(board, max_num_iters / Board::kWidth_);
+            us_timer.Stop();
+            Int num_nodes = 0;
+            for (Int i=0; i<root_parallel.num_envs(); ++i) {
+                num_nodes += root_parallel.num_nodes(i);
+            }
+            std::cout << "transposition: " << (transposition? "on" : "off")
+                << ", root parallel playouts/sec: " << max_num_iters * 1e6 / us_timer.duration()
+                << ", root parallel nodes: " << num_nodes << std::endl;
+        }
+        for (Int num_playouts : { 1, 4, 16 }) {
+            MCTS root_parallel(std::sqrt(2), num_playouts);
+            us_timer.Restart();
+            root_parallel.NewSearch(board, max_num_iters / Board::kWidth_);
+            us_timer.Stop();
+            std::cout << "playouts per leaf: " << num_playouts
+                << ", root parallel rollouts/sec: " << max_num_iters * num_playouts * 1e6 / us_timer.duration() << std::endl;
+        }
+        if constexpr (rlop::kMCTSStats) {
+            MCTS root_parallel;
+            root_parallel.NewSearch(board, max_num_iters / Board::kWidth_);
+            rlop::MCTSStats stats;
+            for (Int i=0; i<root_parallel.num_envs(); ++i) {
+                stats += root_parallel.stats(i);
+            }
+            std::cout << "root parallel stats: iters/sec per thread: " << stats.iters_per_sec()
+                << ", max depth: " << stats.max_depth
+                << ", nodes: " << stats.num_nodes
+                << ", memory: " << stats.memory
+                << ", select/expand/simulate/backpropagate ms: " << stats.select_time / 1e6 << "/" << stats.expand_time / 1e6 
+                << "/" << stats.simulate_time / 1e6 << "/" << stats.backpropagate_time / 1e6 << std::endl;
+        }
+    }
     return 0;
 }
\ No newline at end of file
@@ -1,14 +1,61 @@
 #pragma once
 #include "problems/connect4/problem.h"
 #include "rlop/mcts/root_parallel_puct.h"
+#include "rlop/mcts/root_parallel_rollout_mcts.h"
+#include "rlop/mcts/tree_parallel_mcts.h"
 
 namespace connect4 {
-    class MCTS : public rlop::RootParallelMCTS {
+    // Plays uniformly random columns on a copy of the board. As in the simulation of MCTS, an illegal move ends the
+    // playout, and the reward is from the perspective of the player to move at the root of the environment.
+    class Rollout {
     public:
-        MCTS(double coef = std::sqrt(2)) : problem_(Board::kWidth_), rlop::RootParallelMCTS(Board::kWidth_, coef) {}
+        // Loads the state of an environment.
+        //
+        // Parameters:
+        //   board: The board of the environment.
+        //   num_moves: The number of moves made since the root of the environment.
+        void Load(const Board& board, Int num_moves) {
+            board_bk_ = board;
+            num_moves_bk_ = num_moves;
+        }
+
+        void Restart() {
+            board_ = board_bk_;
+            num_moves_ = num_moves_bk_;
+        }
+
+        bool Step(rlop::Random& rand) {
+            if (!board_.MakeMove(rand.UniformIndex(Board::kWidth_)))
+                return false;
+            ++num_moves_;
+            return !board_.IsOver();
+        }
+
+        double Reward() const {
+            if (board_.Win())
+                return num_moves_ % 2 == 0? 1 : -1;
+            else if (board_.IsFull())
+                return 0;
+            else
+                return num_moves_ % 2 == 0? -1 : 1;
+        }
+
+    private:
+        Board board_;
+        Board board_bk_;
+        Int num_moves_ = 0;
+        Int num_moves_bk_ = 0;
+    };
+
+    class MCTS : public rlop::RootParallelRolloutMCTS<Rollout> {
+    public:
+        MCTS(double coef = std::sqrt(2), Int num_playouts = 1) : 
+            problem_(Board::kWidth_), 
+            rlop::RootParallelRolloutMCTS<Rollout>(Board::kWidth_, num_playouts, coef) 
+        {}
 
         void Reset() override {
-            rlop::RootParallelMCTS::Reset();
+            rlop::RootParallelRolloutMCTS<Rollout>::Reset();
             stacks_ = std::vector<std::vector<Int>>(problem_.num_problems());
             for (Int i=0; i<problem_.num_problems(); ++i) {
                 paths_[i].reserve(64);
@@ -59,17 +106,69 @@ namespace connect4 {
             }
         }
 
+        void LoadRollout(Int env_i, Rollout* rollout) override {
+            rollout->Load(problem_.boards()[env_i], stacks_[env_i].size());
+        }
+
+        uint64_t StateKey(Int env_i) override {
+            return problem_.boards()[env_i].PositionEncode();
+        }
+
         void UpdateNode(Int env_i, double reward) const override {
             if (paths_[env_i].size() % 2 == 1)
-               rlop::RootParallelMCTS::UpdateNode(env_i, reward);
+               rlop::RootParallelRolloutMCTS<Rollout>::UpdateNode(env_i, reward);
             else
-               rlop::RootParallelMCTS::UpdateNode(env_i, -reward);
+               rlop::RootParallelRolloutMCTS<Rollout>::UpdateNode(env_i, -reward);
         }
         
-        Int NewSearch(const Board& board, Int max_num_iters = 6000) {
+        // Searches a position from empty trees.
+        //
+        // Parameters:
+        //   board: The position to search.
+        //   max_num_iters: The maximum number of iterations of each root move.
+        //   time_limit: The time limit in milliseconds of the whole search. Default is kIntFull, i.e., no limit.
+        Int NewSearch(const Board& board, Int max_num_iters = 6000, int64_t time_limit = kIntFull) {
             if (board.IsOver())
                 return kIntNull;
             Reset();
+            return SearchRootMoves(board, max_num_iters, time_limit);
+        }
+
+        // Searches the position reached by a move returned by the previous search followed by a reply of the opponent.
+        // The tree of each environment starts from the matching subtree of the previous search instead of an empty tree.
+        //
+        // Parameters:
+        //   board: The position after the move and the reply.
+        //   move: The move returned by the previous search.
+        //   reply: The reply of the opponent.
+        //   max_num_iters: The maximum number of iterations of each root move.
+        //   time_limit: The time limit in milliseconds of the whole search. Default is kIntFull, i.e., no limit.
+        Int ContinueSearch(const Board& board, Int move, Int reply, Int max_num_iters = 6000, int64_t time_limit = kIntFull) {
+            if (board.IsOver())
+                return kIntNull;
+            const Node* reply_node = nullptr;
+            if (move >= 0 && move < num_envs()) {
+                const Node* root = paths_[move].front();
+                if (reply >= 0 && reply < root->children.size())
+                    reply_node = root->children[reply];
+            }
+            for (Int i=0; i<num_envs(); ++i) {
+                if (i == move)
+                    continue;
+                Reroot(i, reply_node != nullptr && i < reply_node->children.size()? reply_node->children[i] : nullptr);
+            }
+            if (move >= 0 && move < num_envs())
+                Reroot(move, reply_node != nullptr && move < reply_node->children.size()? reply_node->children[move] : nullptr);
+            for (Int i=0; i<num_envs(); ++i) {
+                stacks_[i].clear();
+            }
+            return SearchRootMoves(board, max_num_iters, time_limit);
+        }
+
+    protected:
+        // Searches the tree of each root move in parallel and returns the best move.
+        Int SearchRootMoves(const Board& board, Int max_num_iters, int64_t time_limit) {
+            StartClock(time_limit);
             Int best_i = kIntNull;
             double score = std::numeric_limits<double>::lowest();
             #pragma omp parallel for
@@ -104,6 +203,109 @@ namespace connect4 {
             return best_i; 
         }
 
+        VectorProblem problem_;
+        std::vector<std::vector<Int>> stacks_;
+    };
+
+    class TreeParallelMCTS : public rlop::TreeParallelMCTS {
+    public:
+        TreeParallelMCTS(Int num_threads, double coef = std::sqrt(2)) : rlop::TreeParallelMCTS(num_threads, coef), problem_(num_threads) {}
+
+        void Reset() override {
+            rlop::TreeParallelMCTS::Reset();
+            stacks_ = std::vector<std::vector<Int>>(problem_.num_problems());
+            for (Int i=0; i<problem_.num_problems(); ++i) {
+                paths_[i].reserve(64);
+                stacks_[i].reserve(64);
+            }
+        }
+
+        Int NumChildStates(Int env_i) const override {
+            return problem_.NumMoves();
+        }
+
+        bool IsExpanded(Int env_i, const Node& node) const override {
+            return node.num_visits > 3*NumChildStates(env_i) && node.num_children == NumChildStates(env_i); 
+        }
+
+        void RevertState(Int env_i) override {
+            while (!stacks_[env_i].empty()) {
+                problem_.Undo(env_i, stacks_[env_i].back());
+                stacks_[env_i].pop_back();
+            }
+        }
+
+        bool Step(Int env_i, Int child_i) override {
+            Int move = problem_.GetMove(child_i);
+            if (!problem_.Step(env_i, move))
+                return false;
+            stacks_[env_i].push_back(move);
+            if (problem_.boards()[env_i].IsOver())
+                return false;
+            return true;
+        }
+
+        // Returns the reward from the perspective of the player to move at the root. A rollout stopped by a move into a
+        // full column is scored the opposite of a win at the same depth, the same as Rollout::Reward() and
+        // MCTS::Reward().
+        double Reward(Int env_i) override {
+            if (problem_.boards()[env_i].Win()) {
+                if (stacks_[env_i].size() % 2 == 1)
+                    return 1;
+                else
+                    return -1;
+            }
+            else if (problem_.boards()[env_i].IsFull()) {
+                return 0;
+            }
+            else {
+                if (stacks_[env_i].size() % 2 == 1)
+                    return -1;
+                else
+                    return 1;
+            }
+        }
+
+        void UpdateNode(Int env_i, double reward) const override {
+            if (paths_[env_i].size() % 2 == 0)
+               rlop::TreeParallelMCTS::UpdateNode(env_i, reward);
+            else
+               rlop::TreeParallelMCTS::UpdateNode(env_i, -reward);
+        }
+
+        Int NewSearch(const Board& board, Int max_num_iters = 42000) {
+            if (board.IsOver())
+                return kIntNull;
+            Reset();
+            for (Int i=0; i<problem_.num_problems(); ++i) {
+                problem_.Reset(i, board);
+            }
+            for (Int i=0; i<problem_.NumMoves(); ++i) {
+                Int move = problem_.GetMove(i);
+                if (problem_.Step(0, move)) {
+                    bool win = problem_.boards()[0].Win();
+                    problem_.Undo(0, move);
+                    if (win)
+                        return move;
+                }
+            }
+            SearchAsync(max_num_iters);
+            Int best_i = kIntNull;
+            Int best_num_visits = -1;
+            for (Int i=0; i<NumChildSlots(*root_); ++i) {
+                const Node* child = GetChild(*root_, i);
+                if (child == nullptr || !board.IsPlayable(problem_.GetMove(i)))
+                    continue;
+                if (child->num_visits > best_num_visits) {
+                    best_i = i;
+                    best_num_visits = child->num_visits;
+                }
+            }
+            if (best_i == kIntNull)
+                return kIntNull;
+            return problem_.GetMove(best_i);
+        }
+
     protected:
         VectorProblem problem_;
         std::vector<std::vector<Int>> stacks_;
@@ -0,0 +1,140 @@
+#pragma once
+#include "problems/connect4/problem.h"
+#include "rlop/common/platform.h"
+
+namespace connect4 {
+    // Keeps the solved values and best moves of the positions of the opening, up to a number of plies, as a sorted array
+    // of 64-bit entries. A book is built by the connect4_book tool and saved to a file, which the searches map into
+    // memory and probe by binary search. A position and its mirror image share an entry, keyed by the smaller code.
+    //
+    // File layout: a Header followed by the entries in ascending order. Each entry packs the code of the position in the
+    // upper 56 bits, the best move in bits 2-7 and the value plus one, i.e., 0 for a loss, 1 for a draw and 2 for a win of
+    // the side to move, in bits 0-1.
+    class OpeningBook {
+    public:
+        static constexpr uint32_t kMagic = 0x424F3443; // "C4OB"
+        static constexpr uint32_t kVersion = 1;
+
+        struct Header {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t max_plies;
+            uint32_t reserved;
+            uint64_t size;
+        };
+
+        OpeningBook() = default;
+
+        virtual ~OpeningBook() = default;
+
+        // Maps a book file into memory, replacing the current entries.
+        //
+        // Parameters:
+        //   path: The path of the file.
+        //
+        // Returns:
+        //   bool: Returns false if the file cannot be mapped or is not a valid book.
+        bool Load(const std::string& path) {
+            Clear();
+            if (!file_.Open(path) || file_.size() < sizeof(Header))
+                return false;
+            Header header;
+            std::memcpy(&header, file_.data(), sizeof(Header));
+            if (header.magic != kMagic || header.version != kVersion || file_.size() != sizeof(Header) + header.size * sizeof(uint64_t)) {
+                file_.Close();
+                return false;
+            }
+            max_plies_ = header.max_plies;
+            data_ = reinterpret_cast<const uint64_t*>(file_.data() + sizeof(Header));
+            size_ = header.size;
+            return true;
+        }
+
+        // Saves the entries to a book file.
+        //
+        // Returns:
+        //   bool: Returns false if the file cannot be written.
+        bool Save(const std::string& path) const {
+            std::ofstream out(path, std::ios::binary);
+            Header header = { kMagic, kVersion, static_cast<uint32_t>(max_plies_), 0, size_ };
+            out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+            out.write(reinterpret_cast<const char*>(data_), size_ * sizeof(uint64_t));
+            return static_cast<bool>(out);
+        }
+
+        void Clear() {
+            file_.Close();
+            entries_.clear();
+            data_ = nullptr;
+            size_ = 0;
+            max_plies_ = 0;
+        }
+
+        // Adds solved positions to an in-memory book, which can be probed right away, e.g., by the searches solving the
+        // positions of fewer plies while the book is built.
+        //
+        // Parameters:
+        //   boards: The positions, none of which is over.
+        //   results: The best move and the value, -1, 0 or 1, of each position from the perspective of the side to move.
+        //            Every move should be a column, even for a lost position.
+        void Add(const std::vector<Board>& boards, const std::vector<std::pair<Int, Int>>& results) {
+            if (file_.IsOpen())
+                Clear();
+            for (size_t i=0; i<boards.size(); ++i) {
+                auto [code, mirrored] = Canonicalize(boards[i].PositionEncode());
+                auto [move, value] = results[i];
+                if (move < 0 || move >= Board::kWidth_)
+                    throw std::runtime_error("OpeningBook: move " + std::to_string(move) + " is not a column.");
+                if (mirrored)
+                    move = Board::kWidth_ - 1 - move;
+                entries_.push_back((code << 8) | (static_cast<uint64_t>(move) << 2) | static_cast<uint64_t>(value + 1));
+                max_plies_ = std::max(max_plies_, static_cast<Int>(boards[i].num_moves()));
+            }
+            std::sort(entries_.begin(), entries_.end());
+            data_ = entries_.data();
+            size_ = entries_.size();
+        }
+
+        // Looks up a position.
+        //
+        // Returns:
+        //   std::optional<std::pair<Int, Int>>: The best move and the value, -1, 0 or 1, of the position from the
+        //                                       perspective of the side to move, or std::nullopt if it is not in the book.
+        std::optional<std::pair<Int, Int>> Probe(const Board& board) const {
+            if (board.num_moves() > max_plies_ || size_ == 0)
+                return std::nullopt;
+            auto [code, mirrored] = Canonicalize(board.PositionEncode());
+            uint64_t lower = code << 8;
+            const uint64_t* it = std::lower_bound(data_, data_ + size_, lower);
+            if (it == data_ + size_ || (*it >> 8) != code)
+                return std::nullopt;
+            Int move = (*it >> 2) & 0x3F;
+            Int value = static_cast<Int>(*it & 3) - 1;
+            if (mirrored)
+                move = Board::kWidth_ - 1 - move;
+            return std::pair<Int, Int>{ move, value };
+        }
+
+        // Returns the maximum number of plies of the positions in the book.
+        Int max_plies() const {
+            return max_plies_;
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+    protected:
+        // Returns the smaller code of a position and its mirror image, and whether it is the mirror image.
+        static std::pair<uint64_t, bool> Canonicalize(Board::bitboard code) {
+            Board::bitboard mirror = Board::MirrorEncode(code);
+            return mirror < code? std::pair<uint64_t, bool>{ mirror, true } : std::pair<uint64_t, bool>{ code, false };
+        }
+
+        rlop::MappedFile file_;
+        std::vector<uint64_t> entries_;
+        const uint64_t* data_ = nullptr;
+        uint64_t size_ = 0;
+        Int max_plies_ = 0;
+    };
+}
\ No newline at end of file
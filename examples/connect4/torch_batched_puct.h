@@ -0,0 +1,103 @@
+#pragma once
+#include "batched_puct.h"
+#include "rlop/mcts/torch_batched_puct.h"
+
+namespace connect4 {
+    // A tiny policy-value network of the stones of both players, which shows how a libtorch model plugs into the batched
+    // search. It is not trained, so the search plays by its terminal rewards mostly.
+    class PolicyValueNet : public torch::nn::Module {
+    public:
+        PolicyValueNet(Int hidden_dim = 64) :
+            hidden_net_(2 * Board::kSize_, hidden_dim),
+            policy_net_(hidden_dim, Board::kWidth_),
+            value_net_(hidden_dim, 1)
+        {
+            register_module("hidden_net", hidden_net_);
+            register_module("policy_net", policy_net_);
+            register_module("value_net", value_net_);
+        }
+
+        // Returns the logits of the columns and the values, both from the perspective of the player to move.
+        std::array<torch::Tensor, 2> forward(const torch::Tensor& observations) {
+            torch::Tensor latent = torch::relu(hidden_net_->forward(observations));
+            return { policy_net_->forward(latent), torch::tanh(value_net_->forward(latent)).flatten() };
+        }
+
+    protected:
+        torch::nn::Linear hidden_net_;
+        torch::nn::Linear policy_net_;
+        torch::nn::Linear value_net_;
+    };
+
+    // Evaluates the pending leaves by PolicyValueNet in a single forward pass per batch.
+    class TorchBatchedPUCT : public BatchedPUCTBase<rlop::TorchBatchedPUCT> {
+    public:
+        TorchBatchedPUCT(Int batch_size = 32, int64_t timeout = 1000, double coef = 1.25, double virtual_loss = 1.0) :
+            BatchedPUCTBase<rlop::TorchBatchedPUCT>(batch_size, timeout, coef, virtual_loss),
+            model_(std::make_shared<PolicyValueNet>())
+        {
+            model_->eval();
+        }
+
+        void Reset() override {
+            BatchedPUCTBase<rlop::TorchBatchedPUCT>::Reset();
+            leaves_.clear();
+        }
+
+        // Returns the stones of the player to move followed by the stones of the opponent, and records the leaf to
+        // mask the columns and convert the values of the batch.
+        torch::Tensor Observe() override {
+            leaves_.push_back({ board_, Depth() });
+            torch::Tensor observation = torch::zeros({ 2, Board::kSize_ });
+            auto accessor = observation.accessor<float, 2>();
+            Int player = board_.num_moves() % 2;
+            for (int col=0; col<Board::kWidth_; ++col) {
+                for (int row=0; row<Board::kHeight_; ++row) {
+                    Board::bitboard mask = static_cast<Board::bitboard>(1) << (row + Board::kH1_ * col);
+                    if (board_.players()[player] & mask)
+                        accessor[0][row * Board::kWidth_ + col] = 1;
+                    else if (board_.players()[1 - player] & mask)
+                        accessor[1][row * Board::kWidth_ + col] = 1;
+                }
+            }
+            return observation.flatten();
+        }
+
+        // Runs the model, and moves the probabilities of the playable columns of each leaf to the front of its row,
+        // in the order of the children, and the values to the perspective of the player to move at the root.
+        std::array<torch::Tensor, 2> Predict(const torch::Tensor& observations) override {
+            auto [logits, values] = model_->forward(observations);
+            Int num_leaves = observations.size(0);
+            torch::Tensor priors = torch::zeros({ num_leaves, Board::kWidth_ });
+            torch::Tensor probs = torch::softmax(logits, 1);
+            auto prob_accessor = probs.accessor<float, 2>();
+            auto prior_accessor = priors.accessor<float, 2>();
+            auto value_accessor = values.accessor<float, 1>();
+            for (Int i=0; i<num_leaves; ++i) {
+                const auto& [board, depth] = leaves_[i];
+                float sum = 0;
+                for (int col=0; col<Board::kWidth_; ++col) {
+                    if (board.IsPlayable(col))
+                        sum += prob_accessor[i][col];
+                }
+                Int child_i = 0;
+                for (int col=0; col<Board::kWidth_; ++col) {
+                    if (board.IsPlayable(col))
+                        prior_accessor[i][child_i++] = prob_accessor[i][col] / sum;
+                }
+                if (depth % 2 == 1)
+                    value_accessor[i] = -value_accessor[i];
+            }
+            leaves_.erase(leaves_.begin(), leaves_.begin() + num_leaves);
+            return { priors, values };
+        }
+
+        std::shared_ptr<PolicyValueNet> model() const {
+            return model_;
+        }
+
+    protected:
+        std::shared_ptr<PolicyValueNet> model_;
+        std::vector<std::pair<Board, Int>> leaves_;
+    };
+}
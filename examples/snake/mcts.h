@@ -1,18 +1,19 @@
 
 #pragma once
 #include "problems/snake/problem.h"
-#include "rlop/mcts/mcts.h"
+#include "rlop/mcts/rollout_mcts.h"
+#include "rollout.h"
 
 namespace snake {
-    class MCTS : public rlop::MCTS {
+    class MCTS : public rlop::RolloutMCTS<Rollout> {
     public:
-        MCTS(Int max_depth = 200, double coef = std::sqrt(2)) : 
+        MCTS(Int max_depth = 200, double coef = std::sqrt(2), Int num_playouts = 1) : 
             max_depth_(max_depth),
-            rlop::MCTS(coef)
+            rlop::RolloutMCTS<Rollout>(num_playouts, coef)
         {}
         
         void Reset() override {
-            rlop::MCTS::Reset();
+            rlop::RolloutMCTS<Rollout>::Reset();
             path_.reserve(max_depth_);
         }
 
@@ -39,24 +40,41 @@ namespace snake {
         }
 
         double Reward() override {
-            if (problem_.engine().snakes()[0].alive)
-                return (problem_.engine().snakes()[0].num_foods + problem_.engine().min_num_foods()) / (double)problem_.grid_size() + 0.002 * depth_ / (double)max_depth_;
-            else 
-                return problem_.engine().snakes()[0].num_foods / (double)problem_.grid_size() + 0.001 * depth_ / (double)max_depth_;
+            return Rollout::Score(problem_.engine(), depth_, max_depth_);
+        }
+
+        void LoadRollout(Rollout* rollout) override {
+            rollout->Load(problem_.engine(), depth_, max_depth_);
         }
 
         template<typename TEngine>
-        Int NewSearch(TEngine&& engine, Int max_num_iters) {
+        Int NewSearch(TEngine&& engine, Int max_num_iters, int64_t time_limit = kIntFull) {
             if (!engine.snakes()[0].alive)
                 return kIntNull;
             Reset();
             engine_bk_ = std::forward<TEngine>(engine);
-            Search(max_num_iters);
+            Search(max_num_iters, time_limit);
+            return SelectBestChild();
+        }
+
+        // Searches the state reached by taking a child of the root in the previous search, starting from the subtree
+        // of that child instead of an empty tree.
+        template<typename TEngine>
+        Int ContinueSearch(TEngine&& engine, Int child_i, Int max_num_iters, int64_t time_limit = kIntFull) {
+            if (!engine.snakes()[0].alive)
+                return kIntNull;
+            Advance(child_i);
+            engine_bk_ = std::forward<TEngine>(engine);
+            Search(max_num_iters, time_limit);
+            return SelectBestChild();
+        }
+
+        Int SelectBestChild() const {
             Int best_i = kIntNull;
             double best_score = std::numeric_limits<double>::lowest();
             for (Int i=0; i < path_.front()->children.size(); ++i) {
                 Int dir = problem_.GetAction(i);
-                if(engine.Lookahead(0, dir)) {
+                if(path_.front()->children[i] != nullptr && engine_bk_.Lookahead(0, dir)) {
                     double score = path_.front()->children[i]->num_visits;
                     if (score > best_score) {
                         best_score = score;
@@ -70,10 +88,14 @@ namespace snake {
         void Evaluate(Int num_time_steps, bool render, Int max_num_iters = 30000) {
             Problem problem(render);
             problem.Reset();
+            Int last_i = kIntNull;
             for (Int i=0; i< num_time_steps; ++i) {
-                Int dir = NewSearch(problem.engine(), max_num_iters);
-                if (!problem.Step({ dir == kIntNull? 0 : dir }))
+                Int dir = last_i == kIntNull? NewSearch(problem.engine(), max_num_iters) : ContinueSearch(problem.engine(), last_i, max_num_iters);
+                last_i = dir;
+                if (!problem.Step({ dir == kIntNull? 0 : dir })) {
                     problem.Reset();
+                    last_i = kIntNull;
+                }
                 problem.Render();
             }
         }
@@ -0,0 +1,54 @@
+#pragma once
+#include "problems/snake/engine.h"
+
+namespace snake {
+    // Plays uniformly random directions on a copy of the engine until the episode ends or the maximum depth of the
+    // search is reached. The engine is restored by assignment, which reuses the storage of its containers.
+    class Rollout {
+    public:
+        // Returns the reward of a state at a given depth of the search.
+        static double Score(const Engine& engine, Int depth, Int max_depth) {
+            if (engine.snakes()[0].alive)
+                return (engine.snakes()[0].num_foods + engine.min_num_foods()) / (double)engine.grid_size() + 0.002 * depth / (double)max_depth;
+            else 
+                return engine.snakes()[0].num_foods / (double)engine.grid_size() + 0.001 * depth / (double)max_depth;
+        }
+
+        // Loads the state of the search.
+        //
+        // Parameters:
+        //   engine: The engine at the leaf.
+        //   depth: The depth of the leaf.
+        //   max_depth: The maximum depth of the search.
+        void Load(const Engine& engine, Int depth, Int max_depth) {
+            engine_bk_ = engine;
+            depth_bk_ = depth;
+            max_depth_ = max_depth;
+        }
+
+        void Restart() {
+            engine_ = engine_bk_;
+            depth_ = depth_bk_;
+        }
+
+        bool Step(rlop::Random& rand) {
+            engine_.SetDir(0, rand.UniformIndex(Int(4)));
+            engine_.Update();
+            if (engine_.IsEnd() || depth_ >= max_depth_)
+                return false;
+            ++depth_;
+            return true;
+        }
+
+        double Reward() const {
+            return Score(engine_, depth_, max_depth_);
+        }
+
+    private:
+        Engine engine_;
+        Engine engine_bk_;
+        Int depth_ = 0;
+        Int depth_bk_ = 0;
+        Int max_depth_ = 0;
+    };
+}
@@ -0,0 +1,84 @@
+#include "problems/vrp/insertion_solver.h"
+#include "local_search.h"
+#include "tabu_search.h"
+#include "rlop/common/timer.h"
+
+// Benchmarks the parallel neighborhood evaluation of local search and tabu search on a random instance built like the
+// one of main.cc, for each number of threads. The searches run a fixed number of iterations from the same insertion
+// solution, so the costs should be the same for any number of threads. If num_candidates is positive, the searches use
+// the granular neighborhood of the num_candidates nearest tasks of each node, in which local search also runs with
+// don't-look bits, re-evaluating only the moves around the nodes changed by each step.
+//
+// Usage: vrp_benchmark [num_tasks] [num_vehicles] [num_iters] [max_threads] [num_candidates]
+int main(int argc, char *argv[]) {
+    using namespace vrp;
+
+    Int num_tasks = argc > 1? std::stoi(argv[1]) : 500;
+    Int num_vehicles = argc > 2? std::stoi(argv[2]) : 10;
+    Int num_iters = argc > 3? std::stoi(argv[3]) : 20;
+    Int max_threads = argc > 4? std::stoi(argv[4]) : 1;
+    Int num_candidates = argc > 5? std::stoi(argv[5]) : 0;
+#ifdef _OPENMP
+    if (argc <= 4)
+        max_threads = omp_get_max_threads();
+#endif
+
+    rlop::Timer timer;
+    rlop::Random rand(0);
+    std::vector<std::vector<Int>> matrix(num_tasks + num_vehicles, std::vector<Int>(num_tasks + num_vehicles, 0));
+    for (Int i=0; i<matrix.size(); ++i) {
+        for (Int j=0; j<matrix[i].size(); ++j) {
+            if (i==j)
+                continue;
+            matrix[i][j] = rand.Uniform(1, 100);
+        }
+    }
+
+    auto get_cost = [&matrix](Int i, Int j){
+        return matrix[i][j];
+    };
+
+    Routes routes(num_vehicles, num_tasks);
+    routes.Reset();
+    ArcCostManager manager(routes, get_cost);
+    manager.Reset();
+    OperatorSpace space(routes);
+    space.Reset();
+    Problem problem(&routes, &space, { &manager });
+    InsertionSolver insertion(&problem);
+    insertion.Solve();
+    std::cout << "insertion: total cost: " << problem.GetTotalCost() << std::endl;
+
+    for (Int num_threads=1; num_threads<=max_threads; num_threads*=2) {
+        LocalSearch local_search(get_cost, num_iters, num_threads);
+        local_search.operator_space().set_num_candidates(num_candidates);
+        local_search.Reset(routes);
+        timer.Restart();
+        local_search.Search(num_iters);
+        timer.Stop();
+        std::cout << "local search: threads: " << num_threads << ", total cost: " << local_search.best_cost()
+            << ", duration: " << timer.duration() << "ms" << std::endl;
+
+        if (num_candidates > 0) {
+            LocalSearch incremental_search(get_cost, num_iters, num_threads);
+            incremental_search.operator_space().set_num_candidates(num_candidates);
+            incremental_search.set_dont_look_bits(true);
+            incremental_search.Reset(routes);
+            timer.Restart();
+            incremental_search.Search(num_iters);
+            timer.Stop();
+            std::cout << "local search with don't-look bits: threads: " << num_threads << ", total cost: "
+                << incremental_search.best_cost() << ", duration: " << timer.duration() << "ms" << std::endl;
+        }
+
+        TabuSearch tabu_search(get_cost, num_iters, 10, num_threads);
+        tabu_search.operator_space().set_num_candidates(num_candidates);
+        tabu_search.Reset(routes);
+        timer.Restart();
+        tabu_search.Search(num_iters);
+        timer.Stop();
+        std::cout << "tabu search: threads: " << num_threads << ", total cost: " << tabu_search.best_cost()
+            << ", duration: " << timer.duration() << "ms" << std::endl;
+    }
+    return 0;
+}
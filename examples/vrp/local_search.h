@@ -5,8 +5,8 @@
 namespace vrp {
     class LocalSearch : public rlop::TabuSearch<Int> {
     public:
-        LocalSearch(const std::function<Int(Int, Int)>& get_cost, Int max_num_unimproved_iters = 50 ) : 
-            rlop::TabuSearch<Int>(max_num_unimproved_iters),
+        LocalSearch(const std::function<Int(Int, Int)>& get_cost, Int max_num_unimproved_iters = 50, Int num_threads = 1) : 
+            rlop::TabuSearch<Int>(max_num_unimproved_iters, num_threads),
             operator_space_(routes_),
             cost_manager_(routes_, get_cost),
             problem_(&routes_, &operator_space_, { &cost_manager_ })
@@ -19,6 +19,9 @@ namespace vrp {
             routes_ = routes;
             operator_space_.Reset();
             cost_manager_.Reset();
+            operator_space_.ResetCandidateLists(cost_manager_.get_cost());
+            selected_i_ = kIntNull;
+            looks_.clear();
         }
 
         void Reset(Routes&& routes) {
@@ -26,6 +29,9 @@ namespace vrp {
             routes_ = std::move(routes);
             operator_space_.Reset();
             cost_manager_.Reset();
+            operator_space_.ResetCandidateLists(cost_manager_.get_cost());
+            selected_i_ = kIntNull;
+            looks_.clear();
         }
 
         Int EvaluateSolution() override {
@@ -41,18 +47,45 @@ namespace vrp {
         }
 
         Int EvaluateNeighbor(Int neighbor_i) override {
-            const Operator* op = problem_.operator_space()->GetNeighbor(neighbor_i);
-            return problem_.EvaluateDelta(*op) + problem_.GetTotalCost();
+            const Operator& op = problem_.operator_space()->GetNeighbor(neighbor_i);
+            return problem_.EvaluateDelta(op) + problem_.GetTotalCost();
         }
 
+        // Streams the neighborhood and keeps the move of the lowest cost, without generating the neighbors. With more
+        // than one thread, the neighborhood is streamed in parallel, see OperatorSpace::FindBestNeighbor().
+        //
+        // Returns:
+        //   std::optional<Int>: The index of the move in the order of GenerateNeighbors(). The move is kept for Step().
         std::optional<Int> Select() override {
-            problem_.operator_space()->GenerateNeighbors();
-            return rlop::TabuSearch<Int>::Select();
+            if (dont_look_bits_ && operator_space_.candidate_lists())
+                return SelectIncremental();
+            Int total_cost = problem_.GetTotalCost();
+            auto best = problem_.operator_space()->FindBestNeighbor(
+                [&](const Operator& op) { return double(problem_.EvaluateDelta(op) + total_cost); },
+                [](const Operator&, double) { return true; },
+                num_threads_
+            );
+            if (!best) {
+                selected_i_ = kIntNull;
+                return std::nullopt;
+            }
+            selected_i_ = best->first;
+            selected_ = best->second;
+            return { selected_i_ };
         }
 
+        // Steps the move of an index in the order of GenerateNeighbors(). The move kept by the last Select() is stepped
+        // without generating the neighbors if the index is the one Select() returned, and the neighbors are generated to
+        // find the move of any other index.
         bool Step(const Int& neighbor_i) override {
-            const Operator* op = problem_.operator_space()->GetNeighbor(neighbor_i);
-            if (!problem_.Step(*op))
+            if (neighbor_i != selected_i_) {
+                problem_.operator_space()->GenerateNeighbors();
+                if (neighbor_i < 0 || neighbor_i >= problem_.operator_space()->NumNeighbors())
+                    return false;
+                selected_ = problem_.operator_space()->GetNeighbor(neighbor_i);
+            }
+            selected_i_ = kIntNull;
+            if (!problem_.Step(selected_))
                 return false;
             return true;
         }
@@ -65,11 +98,143 @@ namespace vrp {
             return best_routes_;
         }
 
+        OperatorSpace& operator_space() {
+            return operator_space_;
+        }
+
+        bool dont_look_bits() const {
+            return dont_look_bits_;
+        }
+
+        // Sets whether Select() re-evaluates only the moves of the nodes around the nodes changed by the last step, see
+        // SelectIncremental(). Takes effect with candidate lists only.
+        void set_dont_look_bits(bool enabled) {
+            dont_look_bits_ = enabled;
+        }
+
     protected:
+        // The best move of a part of the candidate moves of a node, i.e., its swaps and moves, or its reversals.
+        struct NodeBest {
+            Operator op;
+            double delta;
+            Int index; // The index of the move among the candidate moves of the node, or kIntNull if there is none.
+            Int ordinal; // The index of the move among the moves of the same part.
+        };
+
+        // Selects the same move as the streaming Select() over the granular neighborhood, but keeps the best swap or
+        // move and the best reversal of each node, and re-evaluates only the parts whose don't-look bits are cleared
+        // by the dirty nodes of the routes. The arc costs are the only costs, so the delta of a swap or a move depends
+        // only on the links of the nodes it touches, and its bit is cleared for the dirty nodes, the nodes followed by
+        // them and the nodes having them as candidates. The delta of a reversal depends on the whole segment it
+        // reverses, so the bits of the reversals are cleared for all the nodes of the routes containing dirty nodes,
+        // whose swaps and moves are only renumbered.
+        std::optional<Int> SelectIncremental() {
+            Int num_nodes = routes_.num_nodes() + routes_.num_routes();
+            if ((Int)looks_.size() != num_nodes) {
+                looks_.assign(num_nodes, false);
+                two_opt_looks_.assign(num_nodes, false);
+                node_bests_.resize(num_nodes);
+                two_opt_bests_.resize(num_nodes);
+                num_node_moves_.resize(num_nodes);
+            }
+            auto clear = [this](Int node) {
+                looks_[node] = false;
+                two_opt_looks_[node] = false;
+            };
+            const CandidateLists* candidate_lists = operator_space_.candidate_lists();
+            dirty_routes_.assign(routes_.num_routes(), false);
+            for (Int node : routes_.dirty_nodes()) {
+                clear(node);
+                if (routes_.GetLast(node) != kIntNull)
+                    clear(routes_.GetLast(node));
+                for (Int i=0; i<candidate_lists->NumReverseCandidates(node); ++i)
+                    clear(candidate_lists->GetReverseCandidate(node, i));
+                if (routes_.GetRoute(node) != kIntNull)
+                    dirty_routes_[routes_.GetRoute(node)] = true;
+            }
+            routes_.ClearDirtyNodes();
+            for (Int ri=0; ri<routes_.num_routes(); ++ri) {
+                if (!dirty_routes_[ri])
+                    continue;
+                two_opt_looks_[routes_.GetSentinel(ri)] = false;
+                for (Int ni=routes_.GetStart(ri); ni!=routes_.GetSentinel(ri); ni=routes_.GetNext(ni))
+                    two_opt_looks_[ni] = false;
+            }
+
+            operator_space_.UpdatePositions();
+            Int i = 0;
+            Int best = kIntNull;
+            double best_delta = std::numeric_limits<double>::max();
+            const NodeBest kNone = { Operator(), std::numeric_limits<double>::max(), kIntNull, kIntNull };
+            for (Int node=0; node<num_nodes; ++node) {
+                NodeBest& node_best = node_bests_[node];
+                NodeBest& two_opt_best = two_opt_bests_[node];
+                if (!two_opt_looks_[node]) {
+                    bool look = looks_[node];
+                    if (!look)
+                        node_best = kNone;
+                    two_opt_best = kNone;
+                    Int index = 0;
+                    Int ordinal = 0;
+                    operator_space_.VisitCandidateNeighbors(node, [&](const Operator& op) {
+                        if (op.GetType() == Operator::Type::kTwoOpt) {
+                            double delta = problem_.EvaluateDelta(op);
+                            if (delta < two_opt_best.delta)
+                                two_opt_best = { op, delta, index, 0 };
+                        }
+                        else {
+                            // The swaps and the moves of a node that looks are the same, but the reversals before them
+                            // and the order of the nodes of a swap may have changed.
+                            if (!look) {
+                                double delta = problem_.EvaluateDelta(op);
+                                if (delta < node_best.delta)
+                                    node_best = { op, delta, index, ordinal };
+                            }
+                            else if (ordinal == node_best.ordinal) {
+                                node_best.op = op;
+                                node_best.index = index;
+                            }
+                            ++ordinal;
+                        }
+                        ++index;
+                    });
+                    num_node_moves_[node] = index;
+                    looks_[node] = true;
+                    two_opt_looks_[node] = true;
+                }
+                // Takes the first of the best moves of the node in the order of the neighborhood, as Select() does.
+                const NodeBest* candidate_best = &node_best;
+                if (two_opt_best.index != kIntNull && (node_best.index == kIntNull || two_opt_best.delta < node_best.delta ||
+                    (two_opt_best.delta == node_best.delta && two_opt_best.index < node_best.index)))
+                    candidate_best = &two_opt_best;
+                if (candidate_best->index != kIntNull && candidate_best->delta < best_delta) {
+                    best = i + candidate_best->index;
+                    best_delta = candidate_best->delta;
+                    selected_ = candidate_best->op;
+                }
+                i += num_node_moves_[node];
+            }
+            selected_i_ = best;
+            if (best == kIntNull)
+                return std::nullopt;
+            return { best };
+        }
+
         Routes routes_;
         Routes best_routes_;
         ArcCostManager cost_manager_;
         OperatorSpace operator_space_;
         Problem problem_;
+        Operator selected_;
+        Int selected_i_ = kIntNull; // The index of selected_, until it is stepped.
+        bool dont_look_bits_ = false;
+        // The don't-look bits and the best moves of the swaps and moves and of the reversals of the nodes, the numbers of
+        // the candidate moves of the nodes, and the routes of the dirty nodes, of SelectIncremental().
+        std::vector<char> looks_;
+        std::vector<char> two_opt_looks_;
+        std::vector<NodeBest> node_bests_;
+        std::vector<NodeBest> two_opt_bests_;
+        std::vector<Int> num_node_moves_;
+        std::vector<char> dirty_routes_;
     };
 }
\ No newline at end of file
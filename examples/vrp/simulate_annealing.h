@@ -22,6 +22,7 @@ namespace vrp {
             routes_.Reset();
             operator_space_.Reset();
             cost_manager_.Reset();
+            operator_space_.ResetCandidateLists(cost_manager_.get_cost());
         }
 
         void Reset(const Routes& routes) {
@@ -29,6 +30,7 @@ namespace vrp {
             routes_ = routes;
             operator_space_.Reset();
             cost_manager_.Reset();
+            operator_space_.ResetCandidateLists(cost_manager_.get_cost());
         }
 
         void Reset(Routes&& routes) {
@@ -36,6 +38,7 @@ namespace vrp {
             routes_ = std::move(routes);
             operator_space_.Reset();
             cost_manager_.Reset();
+            operator_space_.ResetCandidateLists(cost_manager_.get_cost());
         }
 
         std::optional<Int> SelectRandom() override {
@@ -64,8 +67,8 @@ namespace vrp {
         }
 
         Int EvaluateNeighbor(const Int& op_i) override {
-            auto op = problem_.operator_space()->GetNeighbor(op_i);
-            return problem_.EvaluateDelta(*op) + problem_.GetTotalCost();
+            const Operator& op = problem_.operator_space()->GetNeighbor(op_i);
+            return problem_.EvaluateDelta(op) + problem_.GetTotalCost();
         }
 
         std::optional<Int> Select() override {
@@ -74,8 +77,8 @@ namespace vrp {
         }
 
         bool Step(const Int& op_i) override {
-            auto op = problem_.operator_space()->GetNeighbor(op_i);
-            if (!problem_.Step(*op))
+            const Operator& op = problem_.operator_space()->GetNeighbor(op_i);
+            if (!problem_.Step(op))
                 return false;
             return true;
         }
@@ -88,6 +91,10 @@ namespace vrp {
             return best_routes_;
         }
 
+        OperatorSpace& operator_space() {
+            return operator_space_;
+        }
+
     protected:
         Routes routes_;
         Routes best_routes_;
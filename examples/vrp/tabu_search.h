@@ -8,9 +8,10 @@ namespace vrp {
         TabuSearch(
             const std::function<Int(Int, Int)>& get_cost,
             Int max_num_unimproved_iters = 50, 
-            Int tenure = 10 
+            Int tenure = 10,
+            Int num_threads = 1
         ) : 
-            rlop::TabuSearch<Int>(max_num_unimproved_iters),
+            rlop::TabuSearch<Int>(max_num_unimproved_iters, num_threads),
             operator_space_(routes_),
             cost_manager_(routes_, get_cost),
             problem_(&routes_, &operator_space_, { &cost_manager_ }), 
@@ -25,6 +26,8 @@ namespace vrp {
             routes_.Reset();
             operator_space_.Reset();
             cost_manager_.Reset();
+            operator_space_.ResetCandidateLists(cost_manager_.get_cost());
+            selected_i_ = kIntNull;
         }
 
         void Reset(const Routes& routes) {
@@ -33,6 +36,8 @@ namespace vrp {
             routes_ = routes;
             operator_space_.Reset();
             cost_manager_.Reset();
+            operator_space_.ResetCandidateLists(cost_manager_.get_cost());
+            selected_i_ = kIntNull;
         }
 
         void Reset(Routes&& routes) {
@@ -41,6 +46,8 @@ namespace vrp {
             routes_ = std::move(routes);
             operator_space_.Reset();
             cost_manager_.Reset();
+            operator_space_.ResetCandidateLists(cost_manager_.get_cost());
+            selected_i_ = kIntNull;
         }
 
         Int EvaluateSolution() override {
@@ -52,25 +59,53 @@ namespace vrp {
         }
 
         bool IsTabu(Int neighbor_i) override {
-            const Operator* op = problem_.operator_space()->GetNeighbor(neighbor_i);
-            return tabu_table_.IsTabu(problem_.EncodeOperator(*op));
+            const Operator& op = problem_.operator_space()->GetNeighbor(neighbor_i);
+            return tabu_table_.IsTabu(problem_.EncodeOperator(op));
         }
 
         Int EvaluateNeighbor(Int neighbor_i) override {
-            const Operator* op = problem_.operator_space()->GetNeighbor(neighbor_i);
-            return problem_.EvaluateDelta(*op) + problem_.GetTotalCost();;
+            const Operator& op = problem_.operator_space()->GetNeighbor(neighbor_i);
+            return problem_.EvaluateDelta(op) + problem_.GetTotalCost();
         }
 
+        // Streams the neighborhood and keeps the move of the lowest cost which is not tabu or improves the best cost,
+        // which is the move rlop::TabuSearch::Select() selects over the generated neighbors, without generating them.
+        // With more than one thread, the neighborhood is streamed in parallel, see OperatorSpace::FindBestNeighbor().
+        //
+        // Returns:
+        //   std::optional<Int>: The index of the move in the order of GenerateNeighbors(). The move is kept for Step().
         std::optional<Int> Select() override {
-            problem_.operator_space()->GenerateNeighbors();
-            return rlop::TabuSearch<Int>::Select();
+            Int total_cost = problem_.GetTotalCost();
+            auto best = problem_.operator_space()->FindBestNeighbor(
+                [&](const Operator& op) { return double(problem_.EvaluateDelta(op) + total_cost); },
+                [&](const Operator& op, double cost) {
+                    return cost < best_cost_ || !tabu_table_.IsTabu(problem_.EncodeOperator(op));
+                },
+                num_threads_
+            );
+            if (!best) {
+                selected_i_ = kIntNull;
+                return std::nullopt;
+            }
+            selected_i_ = best->first;
+            selected_ = best->second;
+            return { selected_i_ };
         }
 
+        // Steps the move of an index in the order of GenerateNeighbors(). The move kept by the last Select() is stepped
+        // without generating the neighbors if the index is the one Select() returned, and the neighbors are generated to
+        // find the move of any other index.
         bool Step(const Int& neighbor_i) override {
-            const Operator* op = problem_.operator_space()->GetNeighbor(neighbor_i);
-            if (!problem_.Step(*op))
+            if (neighbor_i != selected_i_) {
+                problem_.operator_space()->GenerateNeighbors();
+                if (neighbor_i < 0 || neighbor_i >= problem_.operator_space()->NumNeighbors())
+                    return false;
+                selected_ = problem_.operator_space()->GetNeighbor(neighbor_i);
+            }
+            selected_i_ = kIntNull;
+            if (!problem_.Step(selected_))
                 return false;
-            tabu_table_.Tabu(problem_.EncodeOperator(*op), tenure_);
+            tabu_table_.Tabu(problem_.EncodeOperator(selected_), tenure_);
             return true;
         }
 
@@ -95,6 +130,10 @@ namespace vrp {
             tenure_ = num;    
         }
 
+        OperatorSpace& operator_space() {
+            return operator_space_;
+        }
+
     protected:
         Int tenure_;
         Routes routes_;
@@ -103,5 +142,7 @@ namespace vrp {
         OperatorSpace operator_space_;
         Problem problem_;
         rlop::HashTabuTable<Int> tabu_table_;
+        Operator selected_;
+        Int selected_i_ = kIntNull; // The index of selected_, until it is stepped.
     };
 }
\ No newline at end of file
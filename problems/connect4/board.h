@@ -13,6 +13,7 @@ namespace connect4 {
         static constexpr int kH2_ = kHeight_ + 2;
         static constexpr int kCol1_ = (((bitboard)1<<kH1_)-(bitboard)1);
         static constexpr bitboard kBottom = 0b0000001000000100000010000001000000100000010000001;
+        static constexpr bitboard kBoardMask = kBottom * ((static_cast<bitboard>(1) << kHeight_) - 1);
 
         /*
         .  .  .  .  .  .  .
@@ -104,6 +105,52 @@ namespace connect4 {
             return players_[num_moves_ % 2] + players_[0] + players_[1] + kBottom;
         }
 
+        // Returns the code of the position after playing a column, without playing it, as PositionEncode() would.
+        bitboard PositionEncode(int col) const {
+            bitboard mask = players_[0] | players_[1] | (static_cast<bitboard>(1) << (heights_[col] + kH1_ * col));
+            return players_[1 - num_moves_ % 2] + mask + kBottom;
+        }
+
+        // Returns the cells where the next disc can be dropped, one per column that is not full.
+        bitboard PlayableCells() const {
+            return ((players_[0] | players_[1]) + kBottom) & kBoardMask;
+        }
+
+        // Returns the playable cells that complete four in a row for the side to move, i.e., the columns that win the
+        // game immediately, computed on the bitboards without making any move.
+        bitboard WinningCells() const {
+            bitboard p = players_[num_moves_ % 2];
+            // Vertical.
+            bitboard r = (p << 1) & (p << 2) & (p << 3);
+            for (int shift : { kH1_, kHeight_, kH2_ }) {
+                bitboard t = (p << shift) & (p << 2 * shift);
+                r |= t & (p << 3 * shift);
+                r |= t & (p >> shift);
+                t = (p >> shift) & (p >> 2 * shift);
+                r |= t & (p << shift);
+                r |= t & (p >> 3 * shift);
+            }
+            return r & PlayableCells();
+        }
+
+        // Returns whether a column wins the game immediately for the side to move.
+        bool IsWinningMove(int col) const {
+            return WinningCells() & ColumnMask(col);
+        }
+
+        // Returns the code of the mirror image of a position given its code, in which the columns are reversed.
+        static bitboard MirrorEncode(bitboard code) {
+            bitboard rev = 0;
+            for (int col=0; col<kWidth_; ++col, code >>= kH1_) {
+                rev = (rev << kH1_) | (code & kCol1_);
+            }
+            return rev;
+        }
+
+        static constexpr bitboard ColumnMask(int col) {
+            return static_cast<bitboard>(kCol1_) << (kH1_ * col);
+        }
+
         virtual bool MakeMove(int col) {
             if (col < 0 || col >= kWidth_ || heights_[col] >= kHeight_)
                 return false;
@@ -0,0 +1,84 @@
+#pragma once
+#include "routes.h"
+
+namespace vrp {
+    // Keeps the nearest tasks of each node, including the sentinels of the routes, by the cost of the arc from the node.
+    // OperatorSpace uses the lists to restrict the neighborhood to the moves that connect a node to one of its candidates,
+    // i.e., a granular neighborhood, which takes O(k * n) moves instead of O(n^2) for k candidates of n nodes.
+    class CandidateLists {
+    public:
+        CandidateLists() = default;
+
+        virtual ~CandidateLists() = default;
+
+        // Computes the lists.
+        //
+        // Parameters:
+        //   num_routes: The number of routes, of which the sentinels have lists too.
+        //   num_nodes: The number of tasks.
+        //   get_cost: The cost of the arc from a node to another.
+        //   num_candidates: The number of candidates of each node, which is at most num_nodes - 1.
+        void Reset(Int num_routes, Int num_nodes, const std::function<Int(Int, Int)>& get_cost, Int num_candidates) {
+            num_candidates_ = std::max(std::min(num_candidates, num_nodes - 1), Int(0));
+            candidates_.resize((num_nodes + num_routes) * num_candidates_);
+            std::vector<std::pair<Int, Int>> costs;
+            costs.reserve(num_nodes);
+            for (Int node=0; node<num_nodes+num_routes; ++node) {
+                costs.clear();
+                for (Int candidate=0; candidate<num_nodes; ++candidate) {
+                    if (candidate != node)
+                        costs.push_back({ get_cost(node, candidate), candidate });
+                }
+                std::partial_sort(costs.begin(), costs.begin() + num_candidates_, costs.end());
+                for (Int i=0; i<num_candidates_; ++i)
+                    candidates_[node * num_candidates_ + i] = costs[i].second;
+            }
+            // Inverts the lists in compressed form, i.e., the nodes having node i as a candidate are stored from
+            // reverse_offsets_[i] to reverse_offsets_[i + 1].
+            reverse_offsets_.assign(num_nodes + num_routes + 1, 0);
+            for (Int candidate : candidates_)
+                ++reverse_offsets_[candidate + 1];
+            for (Int i=0; i<num_nodes+num_routes; ++i)
+                reverse_offsets_[i + 1] += reverse_offsets_[i];
+            reverse_candidates_.resize(candidates_.size());
+            std::vector<Int> sizes(num_nodes + num_routes, 0);
+            for (Int node=0; node<num_nodes+num_routes; ++node) {
+                for (Int i=0; i<num_candidates_; ++i) {
+                    Int candidate = GetCandidate(node, i);
+                    reverse_candidates_[reverse_offsets_[candidate] + sizes[candidate]++] = node;
+                }
+            }
+        }
+
+        // Returns the i-th nearest task of a node.
+        Int GetCandidate(Int node, Int i) const {
+            return candidates_[node * num_candidates_ + i];
+        }
+
+        // Returns true if a task is one of the candidates of a node.
+        bool IsCandidate(Int node, Int candidate) const {
+            const Int* begin = candidates_.data() + node * num_candidates_;
+            return std::find(begin, begin + num_candidates_, candidate) != begin + num_candidates_;
+        }
+
+        // Returns the number of the nodes having a node as a candidate.
+        Int NumReverseCandidates(Int node) const {
+            return reverse_offsets_[node + 1] - reverse_offsets_[node];
+        }
+
+        // Returns the i-th node, in ascending order, having a node as a candidate.
+        Int GetReverseCandidate(Int node, Int i) const {
+            return reverse_candidates_[reverse_offsets_[node] + i];
+        }
+
+        Int num_candidates() const {
+            return num_candidates_;
+        }
+
+    protected:
+        Int num_candidates_ = 0;
+        std::vector<Int> candidates_;
+        std::vector<Int> reverse_offsets_;
+        std::vector<Int> reverse_candidates_;
+    };
+}
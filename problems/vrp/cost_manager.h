@@ -52,19 +52,23 @@ namespace vrp {
             return total_cost;
         }
 
-        virtual Int EvaluateDelta(const Operator& op) const { 
-            if (op.GetType() == Operator::Type::kInsertion)
-                return EvaluateDelta(static_cast<const Insertion&>(op));        
-            else if (op.GetType() == Operator::Type::kSwap)
-                return EvaluateDelta(static_cast<const Swapping&>(op));
-            else if (op.GetType() == Operator::Type::kMoving)
-                return EvaluateDelta(static_cast<const Moving&>(op));    
-            else if (op.GetType() == Operator::Type::kTwoOpt)
-                return EvaluateDelta(static_cast<const TwoOpting&>(op));
+        // Evaluates the change of the total cost by a move, dispatching on its type to the non-virtual evaluation of the
+        // type. The same holds for Step() and Undo().
+        virtual Int EvaluateDelta(const Operator& op) const override { 
+            switch (op.GetType()) {
+            case Operator::Type::kInsertion:
+                return EvaluateInsertion(op);
+            case Operator::Type::kSwap:
+                return EvaluateSwap(op);
+            case Operator::Type::kMoving:
+                return EvaluateMove(op);
+            case Operator::Type::kTwoOpt:
+                return EvaluateTwoOpt(op);
+            }
             return 0;
         }
 
-        virtual Int EvaluateDelta(const Insertion& insert) const {
+        Int EvaluateInsertion(const Operator& insert) const {
             if (!routes_->IsInsertable(insert.node(), insert.to_node()))
                 return std::numeric_limits<Int>::max();
             Int last = routes_->GetLast(insert.to_node());
@@ -75,7 +79,7 @@ namespace vrp {
             return cost;
         }
 
-        virtual Int EvaluateDelta(const Swapping& swap) const {
+        Int EvaluateSwap(const Operator& swap) const {
             if (!routes_->IsSwappable(swap.from_node(), swap.to_node()))
                 return std::numeric_limits<Int>::max();
             Int last1 = routes_->GetLast(swap.from_node());
@@ -94,7 +98,7 @@ namespace vrp {
             return cost;
         }
 
-        virtual Int EvaluateDelta(const Moving& move) const {
+        Int EvaluateMove(const Operator& move) const {
             if (!routes_->IsMovable(move.from_node(), move.to_node()))
                 return std::numeric_limits<Int>::max();
             Int node = routes_->GetLast(move.from_node());
@@ -110,7 +114,7 @@ namespace vrp {
             return cost;
         }
 
-        virtual Int EvaluateDelta(const TwoOpting& two_opt) const {
+        Int EvaluateTwoOpt(const Operator& two_opt) const {
             if (!routes_->IsTwoOptable(two_opt.from_node(), two_opt.to_node()))
                 return std::numeric_limits<Int>::max();
             Int from_last = routes_->GetLast(two_opt.from_node());
@@ -128,35 +132,47 @@ namespace vrp {
         }
 
         virtual void Step(const Operator& op) override {
-            if (op.GetType() == Operator::Type::kInsertion)
-                Step(static_cast<const Insertion&>(op));
-            else if (op.GetType() == Operator::Type::kSwap)
-                Step(static_cast<const Swapping&>(op));
-            else if (op.GetType() == Operator::Type::kMoving)
-                Step(static_cast<const Moving&>(op));
-            else if (op.GetType() == Operator::Type::kTwoOpt)
-                Step(static_cast<const TwoOpting&>(op));
-        }
-
-        virtual void Undo(const Operator& op) {
-            if (op.GetType() == Operator::Type::kInsertion)
-                Undo(static_cast<const Insertion&>(op));    
-            else if (op.GetType() == Operator::Type::kSwap)
-                Undo(static_cast<const Swapping&>(op));    
-            else if (op.GetType() == Operator::Type::kMoving)
-                Undo(static_cast<const Moving&>(op));    
-            else if (op.GetType() == Operator::Type::kTwoOpt)
-                Undo(static_cast<const TwoOpting&>(op));    
-        }
-
-        virtual void Step(const Insertion& insert) {
+            switch (op.GetType()) {
+            case Operator::Type::kInsertion:
+                StepInsertion(op);
+                break;
+            case Operator::Type::kSwap:
+                StepSwap(op);
+                break;
+            case Operator::Type::kMoving:
+                StepMove(op);
+                break;
+            case Operator::Type::kTwoOpt:
+                StepTwoOpt(op);
+                break;
+            }
+        }
+
+        virtual void Undo(const Operator& op) override {
+            switch (op.GetType()) {
+            case Operator::Type::kInsertion:
+                UndoInsertion(op);
+                break;
+            case Operator::Type::kSwap:
+                UndoSwap(op);
+                break;
+            case Operator::Type::kMoving:
+                UndoMove(op);
+                break;
+            case Operator::Type::kTwoOpt:
+                UndoTwoOpt(op);
+                break;
+            }
+        }
+
+        void StepInsertion(const Operator& insert) {
             Int last = routes_->GetLast(insert.node());
             total_cost_ -= get_cost_(last, insert.to_node());
             total_cost_ += get_cost_(last, insert.node());
             total_cost_ += get_cost_(insert.node(), insert.to_node());
         }
 
-        virtual void Undo(const Insertion& insert) {
+        void UndoInsertion(const Operator& insert) {
             Int last = routes_->GetLast(insert.node());
             Int next = routes_->GetNext(insert.node());
             total_cost_ += get_cost_(last, next);
@@ -164,7 +180,7 @@ namespace vrp {
             total_cost_ -= get_cost_(insert.node(), next);
         }
 
-        virtual void Step(const Swapping& swap) {
+        void StepSwap(const Operator& swap) {
             Int last1 = routes_->GetLast(swap.from_node());
             Int next1 = routes_->GetNext(swap.from_node());
             Int last2 = routes_->GetLast(swap.to_node());
@@ -179,7 +195,7 @@ namespace vrp {
             total_cost_ -= get_cost_(swap.to_node(), next1); 
         }
 
-        virtual void Undo(const Swapping& swap) {
+        void UndoSwap(const Operator& swap) {
             Int last1 = routes_->GetLast(swap.from_node());
             Int next1 = routes_->GetNext(swap.from_node());
             Int last2 = routes_->GetLast(swap.to_node());
@@ -194,7 +210,7 @@ namespace vrp {
             total_cost_ += get_cost_(swap.to_node(), next1);
         }
 
-        virtual void Step(const Moving& move) {
+        void StepMove(const Operator& move) {
             Int last1 = routes_->GetLast(move.from_node());
             Int node = routes_->GetLast(move.to_node());
             Int last2 = routes_->GetLast(node);
@@ -206,7 +222,7 @@ namespace vrp {
             total_cost_ -= get_cost_(last2, move.to_node());
         }
 
-        virtual void Undo(const Moving& move) {
+        void UndoMove(const Operator& move) {
             Int last1 = routes_->GetLast(move.from_node());
             Int node = routes_->GetLast(move.to_node());
             Int last2 = routes_->GetLast(node);
@@ -218,7 +234,7 @@ namespace vrp {
             total_cost_ += get_cost_(last2, move.to_node());
         }
 
-        virtual void Step(const TwoOpting& two_opt) {
+        void StepTwoOpt(const Operator& two_opt) {
             Int from_next = routes_->GetNext(two_opt.from_node());
             Int to_last = routes_->GetLast(two_opt.to_node());
             for (Int node=two_opt.to_node(); node!=from_next; node=routes_->GetNext(node)) {
@@ -231,7 +247,7 @@ namespace vrp {
             total_cost_ -= get_cost_(two_opt.to_node(), from_next); 
         }
 
-        virtual void Undo(const TwoOpting& two_opt) {
+        void UndoTwoOpt(const Operator& two_opt) {
             Int from_next = routes_->GetNext(two_opt.from_node());
             Int to_last = routes_->GetLast(two_opt.to_node());
             for (Int node=two_opt.to_node(); node!=from_next; node=routes_->GetNext(node)) {
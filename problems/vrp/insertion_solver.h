@@ -13,8 +13,8 @@ namespace vrp {
         virtual void Reset() override {}
 
         virtual Int Evaluate(Int i) const {
-            auto op = problem_->operator_space()->GetInsertion(i);
-            return problem_->EvaluateDelta(*op);
+            const Operator& op = problem_->operator_space()->GetInsertion(i);
+            return problem_->EvaluateDelta(op);
         }
 
         virtual std::optional<Int> Select() {
@@ -38,8 +38,8 @@ namespace vrp {
                 auto i = Select();
                 if (!i)
                     return;
-                auto op = problem_->operator_space()->GetInsertion(*i);
-                if (!problem_->Step(*op))
+                const Operator& op = problem_->operator_space()->GetInsertion(*i);
+                if (!problem_->Step(op))
                     return;
             }
         }
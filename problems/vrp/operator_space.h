@@ -1,19 +1,17 @@
 #pragma once
 #include "rlop/common/random.h"
-#include "operators.h"
+#include "candidate_lists.h"
 
 namespace vrp {
+    // Generates the moves of the neighborhood of routes into flat buffers of Operator records, which keep their capacity
+    // across iterations, so that no memory is allocated once the buffers have grown to the size of the neighborhood.
     class OperatorSpace {
     public:
         OperatorSpace() = default;
 
         OperatorSpace(const Routes& routes) : routes_(&routes) {}
 
-        virtual ~OperatorSpace() {
-            for (auto ptr : operators_) {
-                delete ptr;
-            }
-        }
+        virtual ~OperatorSpace() = default;
 
         virtual void Reset() {
             ClearOperators();
@@ -26,16 +24,10 @@ namespace vrp {
         }
 
         virtual void ClearOperators() {
-            for (auto ptr : operators_) {
-                delete ptr;
-            }
             operators_.clear();
         }
 
         virtual void ClearInsertions() {
-            for (auto ptr : insertions_) {
-                delete ptr;
-            }
             insertions_.clear();
         }
 
@@ -43,7 +35,7 @@ namespace vrp {
             return insertions_.size();
         }
 
-        virtual const Insertion* GetInsertion(Int i) const {
+        virtual const Operator& GetInsertion(Int i) const {
             return insertions_[i];
         }
 
@@ -51,16 +43,16 @@ namespace vrp {
             return operators_.size();
         }
 
-        virtual const Operator* GetNeighbor(Int i) const {
+        virtual const Operator& GetNeighbor(Int i) const {
             return operators_[i];
         }
 
         virtual void GenerateInsertions() {
             ClearInsertions();
-            std::vector<Int> visited;
-            std::vector<Int> unvisited;
-            visited.reserve(routes_->num_nodes());
-            unvisited.reserve(routes_->num_nodes());
+            auto& visited = visited_;
+            auto& unvisited = unvisited_;
+            visited.clear();
+            unvisited.clear();
             for (Int i=0; i<routes_->num_nodes(); ++i) {
                 if (routes_->IsVisited(i))
                     visited.push_back(i);
@@ -71,14 +63,49 @@ namespace vrp {
                 return;
             Int i = unvisited[rand_.Uniform(Int(0), (Int)unvisited.size()-1)];
             for (Int j : visited)
-                insertions_.push_back(new Insertion(i, j));
+                insertions_.push_back(Operator::Insertion(i, j));
             for (Int j=0; j<routes_->num_routes(); ++j)
-                insertions_.push_back(new Insertion(i, routes_->GetSentinel(j)));
+                insertions_.push_back(Operator::Insertion(i, routes_->GetSentinel(j)));
         }
         
-        virtual void GenerateNeighbors() {
-            ClearOperators();
-            for (Int ri=0; ri<routes_->num_routes(); ++ri) {
+        // Enumerates the moves of the neighborhood of the routes in the order of GenerateNeighbors() and passes each to a
+        // visitor, e.g., to evaluate the moves as they are generated and keep only the best one, which takes no memory
+        // for the neighborhood. If candidate lists are set, only the moves of the granular neighborhood are enumerated,
+        // see VisitCandidateNeighbors().
+        //
+        // Parameters:
+        //   visit: The callable invoked as visit(const Operator&) for each move.
+        template<typename Visitor>
+        void VisitNeighbors(Visitor&& visit) {
+            if (candidate_lists_)
+                UpdatePositions();
+            VisitNeighbors(0, NumNeighborParts(), visit);
+        }
+
+        // Returns the number of the parts that the enumeration of the neighborhood is made of, i.e., the routes whose
+        // moves are enumerated in turn, or the nodes if candidate lists are set.
+        Int NumNeighborParts() const {
+            if (candidate_lists_)
+                return routes_->num_nodes() + routes_->num_routes();
+            return routes_->num_routes();
+        }
+
+        // Enumerates the moves of a contiguous range of the parts of the neighborhood, see NumNeighborParts(), in the
+        // order of GenerateNeighbors(). The ranges can be enumerated concurrently. If candidate lists are set,
+        // UpdatePositions() should be called first.
+        //
+        // Parameters:
+        //   begin: The first part of the range.
+        //   end: The part after the last part of the range.
+        //   visit: The callable invoked as visit(const Operator&) for each move.
+        template<typename Visitor>
+        void VisitNeighbors(Int begin, Int end, Visitor&& visit) const {
+            if (candidate_lists_) {
+                for (Int node=begin; node<end; ++node)
+                    VisitCandidateNeighbors(node, visit);
+                return;
+            }
+            for (Int ri=begin; ri<end; ++ri) {
                 if (!routes_->IsStarted(ri))
                     continue;
                 for (Int rj=0; rj<routes_->num_routes(); ++rj) {
@@ -86,15 +113,15 @@ namespace vrp {
                         for (Int ni=routes_->GetStart(ri); ni!=routes_->GetSentinel(ri); ni=routes_->GetNext(ni)) {
                             for (Int nj=routes_->GetNext(ni); nj!=routes_->GetSentinel(rj); nj=routes_->GetNext(nj)) {
                                 if (nj != routes_->GetNext(ni))
-                                    operators_.push_back(new Swapping(ni, nj));
-                                operators_.push_back(new TwoOpting(ni, nj));
+                                    visit(Operator::Swapping(ni, nj));
+                                visit(Operator::TwoOpting(ni, nj));
                             }
                         }
                     }
                     else {
                         for (Int ni=routes_->GetStart(ri); ni!=routes_->GetSentinel(ri); ni=routes_->GetNext(ni)) {
                             for (Int nj=routes_->GetStart(rj); nj!=routes_->GetSentinel(rj); nj=routes_->GetNext(nj)) {
-                                operators_.push_back(new Swapping(ni, nj));
+                                visit(Operator::Swapping(ni, nj));
                             }
                         }
                     }
@@ -102,21 +129,174 @@ namespace vrp {
                         for (Int nj=routes_->GetStart(rj); nj!=routes_->GetSentinel(rj); nj=routes_->GetNext(nj)) {
                             if (ni == nj || nj == routes_->GetLast(ni) || routes_->GetLast(ni) == routes_->GetSentinel(ri))
                                 continue;
-                            operators_.push_back(new Moving(ni, nj));
+                            visit(Operator::Moving(ni, nj));
                         }
                     }
                 }
             }
         }
 
+        // Finds the move of the lowest cost among the moves accepted by a predicate, and the first of them in the order
+        // of GenerateNeighbors() on ties, by enumerating the neighborhood without generating it. With more than one
+        // thread, the parts of the neighborhood are split into contiguous ranges enumerated in parallel, each counting
+        // its moves and keeping its best move, and the ranges are merged in order with the counts of the ranges before
+        // them as the offsets of their indices, so the move is the same as with one thread.
+        //
+        // Parameters:
+        //   evaluate: The callable invoked as evaluate(const Operator&) for the cost of each move.
+        //   accept: The callable invoked as accept(const Operator&, double) for a move and its cost if the move is better
+        //   than the best move of its range so far, which is kept only if it returns true.
+        //   num_threads: The number of threads, defaulted to 1. With more than one, evaluate and accept should be safe
+        //   to call concurrently.
+        //
+        // Returns:
+        //   std::optional<std::pair<Int, Operator>>: The index of the move in the order of GenerateNeighbors() and the
+        //   move, or std::nullopt if no move is accepted.
+        template<typename Evaluator, typename Predicate>
+        std::optional<std::pair<Int, Operator>> FindBestNeighbor(
+            Evaluator&& evaluate, 
+            Predicate&& accept, 
+            Int num_threads = 1
+        ) {
+            if (candidate_lists_)
+                UpdatePositions();
+            Int num_parts = NumNeighborParts();
+            Int num_ranges = std::max(Int(1), std::min(num_threads, num_parts));
+            range_bests_.assign(num_ranges, RangeBest());
+            #pragma omp parallel for num_threads(num_ranges) schedule(static, 1)
+            for (Int i=0; i<num_ranges; ++i) {
+                RangeBest& best = range_bests_[i];
+                VisitNeighbors(num_parts * i / num_ranges, num_parts * (i + 1) / num_ranges, [&](const Operator& op) {
+                    double cost = evaluate(op);
+                    if (cost < best.cost && accept(op, cost)) {
+                        best.index = best.num_moves;
+                        best.cost = cost;
+                        best.op = op;
+                    }
+                    ++best.num_moves;
+                });
+            }
+            Int offset = 0;
+            Int best_i = kIntNull;
+            const RangeBest* best = nullptr;
+            for (const RangeBest& range_best : range_bests_) {
+                if (range_best.index != kIntNull && (!best || range_best.cost < best->cost)) {
+                    best_i = offset + range_best.index;
+                    best = &range_best;
+                }
+                offset += range_best.num_moves;
+            }
+            if (!best)
+                return std::nullopt;
+            return std::make_pair(best_i, best->op);
+        }
+
+        // Enumerates the moves of the full neighborhood that connect a node to its candidates, i.e., if the node is
+        // visited and followed by a task, for each visited candidate of the node:
+        //   Swapping the task and the candidate, unless it is the swap of a smaller node, see IsSwapOfSmallerNode().
+        //   Moving the node before the candidate, if the node is a task.
+        //   Reversing the segment from the task to the candidate, if the candidate is behind the task in the same route.
+        // The moves of a node depend only on the links of the node, the task, the candidates and, by the reversals, the
+        // nodes of the route of the node, which lets a search re-evaluate only the nodes around the dirty nodes of the
+        // routes. UpdatePositions() should be called after the routes are changed.
+        template<typename Visitor>
+        void VisitCandidateNeighbors(Int node, Visitor&& visit) const {
+            if (!routes_->IsVisited(node))
+                return;
+            Int next = routes_->GetNext(node);
+            if (next >= routes_->num_nodes())
+                return;
+            for (Int i=0; i<candidate_lists_->num_candidates(); ++i) {
+                Int candidate = candidate_lists_->GetCandidate(node, i);
+                if (candidate == next || !routes_->IsVisited(candidate))
+                    continue;
+                bool same_route = routes_->GetRoute(candidate) == routes_->GetRoute(node);
+                bool behind = same_route && positions_[candidate] > positions_[next];
+                if (candidate != routes_->GetNext(next) && !IsSwapOfSmallerNode(node, next, candidate))
+                    visit(same_route && !behind? Operator::Swapping(candidate, next) : Operator::Swapping(next, candidate));
+                if (node < routes_->num_nodes())
+                    visit(Operator::Moving(next, candidate));
+                if (behind)
+                    visit(Operator::TwoOpting(next, candidate));
+            }
+        }
+
+        // Returns true if the swap of the task following a node and a candidate of the node is also visited from the node
+        // preceding the candidate, whose candidate the task is, and that node is smaller. The swap is left to the smaller
+        // node, so that it is visited once.
+        bool IsSwapOfSmallerNode(Int node, Int next, Int candidate) const {
+            Int last = routes_->GetLast(candidate);
+            return last < node && next != routes_->GetNext(candidate) && candidate_lists_->IsCandidate(last, next);
+        }
+
+        // Numbers the nodes along their routes, to find which of two nodes of a route comes first.
+        void UpdatePositions() {
+            positions_.resize(routes_->num_nodes() + routes_->num_routes());
+            for (Int ri=0; ri<routes_->num_routes(); ++ri) {
+                Int position = 0;
+                for (Int ni=routes_->GetStart(ri); ni!=routes_->GetSentinel(ri); ni=routes_->GetNext(ni))
+                    positions_[ni] = ++position;
+            }
+        }
+
+        virtual void GenerateNeighbors() {
+            ClearOperators();
+            VisitNeighbors([this](const Operator& op) { operators_.push_back(op); });
+        }
+
         void Seed(uint64_t seed) {
             rand_.Seed(seed);
         }
 
+        // Computes the candidate lists of the routes by the costs of the arcs, or drops them if num_candidates() is not
+        // positive. It should be called after the routes are reset to another instance.
+        //
+        // Parameters:
+        //   get_cost: The cost of the arc from a node to another.
+        void ResetCandidateLists(const std::function<Int(Int, Int)>& get_cost) {
+            if (num_candidates_ <= 0) {
+                candidate_lists_.reset();
+                return;
+            }
+            if (!candidate_lists_)
+                candidate_lists_.emplace();
+            candidate_lists_->Reset(routes_->num_routes(), routes_->num_nodes(), get_cost, num_candidates_);
+        }
+
+        // Returns the candidate lists that restrict the neighborhood, or nullptr for the full neighborhood.
+        const CandidateLists* candidate_lists() const {
+            return candidate_lists_? &*candidate_lists_ : nullptr;
+        }
+
+        Int num_candidates() const {
+            return num_candidates_;
+        }
+
+        // Sets the number of the nearest tasks of each node that the neighborhood connects it to, see CandidateLists. A
+        // number of 0 keeps the full neighborhood. Takes effect from the next ResetCandidateLists().
+        void set_num_candidates(Int num) {
+            num_candidates_ = num;
+        }
+
     protected: 
         const Routes* routes_ = nullptr;
-        std::vector<Operator*> operators_;
-        std::vector<Insertion*> insertions_;
-        rlop::Random rand_;               
+        std::vector<Operator> operators_;
+        std::vector<Operator> insertions_;
+        Int num_candidates_ = 0;
+        std::optional<CandidateLists> candidate_lists_;
+        rlop::Random rand_;
+        // The best move of a range of the parts of the neighborhood in FindBestNeighbor().
+        struct RangeBest {
+            Int num_moves = 0;
+            Int index = kIntNull;
+            double cost = std::numeric_limits<double>::max();
+            Operator op;
+        };
+
+        // Scratch buffers reused by GenerateInsertions(), UpdatePositions() and FindBestNeighbor().
+        std::vector<Int> visited_;
+        std::vector<Int> unvisited_;
+        std::vector<Int> positions_;
+        std::vector<RangeBest> range_bests_;
     };
 }
\ No newline at end of file
@@ -6,85 +6,55 @@ namespace vrp {
     using rlop::kIntNull;
     using rlop::kIntFull;
 
-    class Operator {
+    // A move of the neighborhood, recorded by value as a type tag and two node ids, so that the moves of an iteration
+    // are kept in a flat buffer without any allocation or virtual call. The routes and the cost managers dispatch on
+    // the type:
+    //   kInsertion: Inserts node() before to_node().
+    //   kSwap: Swaps from_node() and to_node().
+    //   kMoving: Moves the node before from_node() to before to_node().
+    //   kTwoOpt: Reverses the segment from from_node() to to_node() of a route.
+    class alignas(16) Operator {
     public:
-        enum class Type {
+        enum class Type : int32_t {
             kInsertion = 0,
             kSwap,
             kMoving,
             kTwoOpt,
         };
 
-        virtual Type GetType() const = 0;
-    };
+        Operator() = default;
 
-    class Insertion : public Operator {
-    public:
-        Insertion(Int node, Int to_node) : node_(node), to_node_(to_node) {}
+        Operator(Type type, Int from_node, Int to_node) :
+            from_node_(static_cast<int32_t>(from_node)),
+            to_node_(static_cast<int32_t>(to_node)),
+            type_(type)
+        {}
 
-        Int node() const {
-            return node_;
+        static Operator Insertion(Int node, Int to_node) {
+            return { Type::kInsertion, node, to_node };
         }
 
-        Int to_node() const {
-            return to_node_;
+        static Operator Swapping(Int from_node, Int to_node) {
+            return { Type::kSwap, from_node, to_node };
         }
 
-        virtual Type GetType() const override {
-            return Type::kInsertion;
+        static Operator Moving(Int from_node, Int to_node) {
+            return { Type::kMoving, from_node, to_node };
         }
 
-    private:
-        Int node_ = kIntNull;
-        Int to_node_ = kIntNull;
-    };
-
-    class Swapping : public Operator {
-    public:
-        Swapping(Int from_node, Int to_node) : from_node_(from_node), to_node_(to_node) {}
-
-        Int from_node() const {
-            return from_node_;
+        static Operator TwoOpting(Int from_node, Int to_node) {
+            return { Type::kTwoOpt, from_node, to_node };
         }
 
-        Int to_node() const {
-            return to_node_;
+        Type GetType() const {
+            return type_;
         }
 
-        virtual Type GetType() const override {
-            return Type::kSwap;
-        }
-
-    private:
-        Int from_node_ = kIntNull;
-        Int to_node_ = kIntNull;
-    };
-
-    class Moving : public Operator {
-    public:
-        Moving(Int from_node, Int to_node) : from_node_(from_node), to_node_(to_node) {}
-
-        Int from_node() const {
+        // Returns the node to insert of an insertion, which is the same as from_node().
+        Int node() const {
             return from_node_;
         }
 
-        Int to_node() const {
-            return to_node_;
-        }
-
-        virtual Type GetType() const override {
-            return Type::kMoving;
-        }
-
-    private:
-        Int from_node_ = kIntNull;
-        Int to_node_ = kIntNull;
-    };
-
-    class TwoOpting : public Operator {
-    public:
-        TwoOpting(Int from_node, Int to_node) : from_node_(from_node), to_node_(to_node) {}
-
         Int from_node() const {
             return from_node_;
         }
@@ -93,12 +63,11 @@ namespace vrp {
             return to_node_;
         }
 
-        virtual Type GetType() const override {
-            return Type::kTwoOpt;
-        }
-
     private:
-        Int from_node_ = kIntNull;
-        Int to_node_ = kIntNull; 
+        int32_t from_node_ = -1;
+        int32_t to_node_ = -1;
+        Type type_ = Type::kInsertion;
     };
+
+    static_assert(sizeof(Operator) == 16, "Operator: a move should take 16 bytes.");
 }
\ No newline at end of file
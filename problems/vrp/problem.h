@@ -40,25 +40,7 @@ namespace vrp {
         }
 
         virtual Int EncodeOperator(const Operator& op) const {
-            if (op.GetType() == Operator::Type::kInsertion) {
-                auto insert = static_cast<const Insertion&>(op);
-                return insert.node() ^ insert.to_node() ^ 0;            
-            }
-            else if (op.GetType() == Operator::Type::kSwap) {
-                auto swap = static_cast<const Swapping&>(op);
-                return swap.from_node() ^ swap.to_node() ^ 1;
-                
-            }
-            else if (op.GetType() == Operator::Type::kMoving) {
-                auto move = static_cast<const Moving&>(op);
-                return move.from_node() ^ move.to_node() ^ 2;    
-
-            }
-            else if (op.GetType() == Operator::Type::kTwoOpt) {
-                auto two_opt = static_cast<const TwoOpting&>(op);
-                return two_opt.from_node() ^ two_opt.to_node() ^ 3;
-            }    
-            return Int(0);
+            return op.from_node() ^ op.to_node() ^ static_cast<Int>(op.GetType());
         }
 
         virtual Int GetTotalCost() const {
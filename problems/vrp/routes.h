@@ -15,6 +15,8 @@ namespace vrp {
             node_to_route_ = std::vector<Int>(num_routes_ + num_nodes_, kIntNull);
             lasts_ = std::vector<Int>(num_routes_ + num_nodes_, kIntNull);
             nexts_ = std::vector<Int>(num_routes_ + num_nodes_, kIntNull);
+            dirty_ = std::vector<char>(num_routes_ + num_nodes_, false);
+            dirty_nodes_.clear();
             for (Int i=0; i<num_routes_; ++i) {
                 lasts_[GetSentinel(i)] = GetSentinel(i);
                 nexts_[GetSentinel(i)] = GetSentinel(i);
@@ -37,45 +39,33 @@ namespace vrp {
         }
 
         virtual bool Step(const Operator& op) {
-            if (op.GetType() == Operator::Type::kInsertion) {
-                auto insert = static_cast<const Insertion&>(op);
-                if (!Insert(insert.node(), insert.to_node()))
-                    return false;
-            }
-            else if (op.GetType() == Operator::Type::kSwap) {
-                auto swap = static_cast<const Swapping&>(op);
-                if (!Swap(swap.from_node(), swap.to_node()))
-                    return false;
-            }
-            else if (op.GetType() == Operator::Type::kMoving) {
-                auto move = static_cast<const Moving&>(op);
-                if (!Move(move.from_node(), move.to_node()))
-                    return false;
-            }
-            else if (op.GetType() == Operator::Type::kTwoOpt) {
-                auto opt = static_cast<const TwoOpting&>(op);
-                if (!TwoOpt(opt.from_node(), opt.to_node()))
-                    return false;
+            switch (op.GetType()) {
+            case Operator::Type::kInsertion:
+                return Insert(op.node(), op.to_node());
+            case Operator::Type::kSwap:
+                return Swap(op.from_node(), op.to_node());
+            case Operator::Type::kMoving:
+                return Move(op.from_node(), op.to_node());
+            case Operator::Type::kTwoOpt:
+                return TwoOpt(op.from_node(), op.to_node());
             }
             return true;
         }
 
         virtual void Undo(const Operator& op) {
-            if (op.GetType() == Operator::Type::kInsertion) {
-                auto insert = static_cast<const Insertion&>(op);
-                Erase(insert.node());
-            }
-            else if (op.GetType() == Operator::Type::kSwap) {
-                auto swap = static_cast<const Swapping&>(op);
-                Swap(swap.from_node(), swap.to_node());
-            }
-            else if (op.GetType() == Operator::Type::kMoving) {
-                auto move = static_cast<const Moving&>(op);
-                Move(move.to_node(), move.from_node());
-            }
-            else if (op.GetType() == Operator::Type::kTwoOpt) {
-                auto two_opt = static_cast<const TwoOpting&>(op);
-                TwoOpt(two_opt.to_node(), two_opt.from_node()); 
+            switch (op.GetType()) {
+            case Operator::Type::kInsertion:
+                Erase(op.node());
+                break;
+            case Operator::Type::kSwap:
+                Swap(op.from_node(), op.to_node());
+                break;
+            case Operator::Type::kMoving:
+                Move(op.to_node(), op.from_node());
+                break;
+            case Operator::Type::kTwoOpt:
+                TwoOpt(op.to_node(), op.from_node());
+                break;
             }
         }
 
@@ -83,6 +73,9 @@ namespace vrp {
             if (!IsErasable(node)) 
                 return false;
             Int route = GetRoute(node);
+            MarkDirty(GetLast(node));
+            MarkDirty(GetNext(node));
+            MarkDirty(node);
             nexts_[GetLast(node)] = GetNext(node);
             lasts_[GetNext(node)] = GetLast(node);
             lasts_[node] = kIntNull;
@@ -95,6 +88,10 @@ namespace vrp {
         bool Insert(Int node, Int to_node) {
             if (!IsInsertable(node, to_node))
                 return false;
+            if (GetLast(to_node) != kIntNull)
+                MarkDirty(GetLast(to_node));
+            MarkDirty(to_node);
+            MarkDirty(node);
             nexts_[node] = to_node;
             lasts_[node] = GetLast(to_node);
             if (GetLast(to_node) != kIntNull)
@@ -108,6 +105,12 @@ namespace vrp {
         bool Swap(Int from_node, Int to_node) {
             if (!IsSwappable(from_node, to_node)) 
                 return false;
+            MarkDirty(GetLast(from_node));
+            MarkDirty(GetNext(from_node));
+            MarkDirty(GetLast(to_node));
+            MarkDirty(GetNext(to_node));
+            MarkDirty(from_node);
+            MarkDirty(to_node);
             nexts_[GetLast(from_node)] = to_node;
             nexts_[GetLast(to_node)] = from_node;
             lasts_[GetNext(from_node)] = to_node;
@@ -122,6 +125,11 @@ namespace vrp {
             if (!IsMovable(from_node, to_node)) 
                 return false;
             Int moved = GetLast(from_node);
+            MarkDirty(GetLast(moved));
+            MarkDirty(moved);
+            MarkDirty(from_node);
+            MarkDirty(GetLast(to_node));
+            MarkDirty(to_node);
             nexts_[GetLast(moved)] = from_node;
             lasts_[from_node] = GetLast(moved);
             nexts_[GetLast(to_node)] = moved;
@@ -137,7 +145,10 @@ namespace vrp {
                 return false;
             Int to_next = GetNext(to_node);
             Int from_last = GetLast(from_node);
+            MarkDirty(from_last);
+            MarkDirty(to_next);
             for (Int node=from_node; node!=to_next; node=GetLast(node)) {
+                MarkDirty(node);
                 std::swap(nexts_[node], lasts_[node]);
             }
             nexts_[from_last] = to_node;
@@ -211,12 +222,39 @@ namespace vrp {
             return num_visited_nodes_;
         }
 
+        // Returns whether the last or the next node or the route of a node, including a sentinel, has changed since
+        // the last ClearDirtyNodes().
+        bool IsDirty(Int node) const {
+            return dirty_[node];
+        }
+
+        // Returns the dirty nodes, each once, in the order they became dirty.
+        const std::vector<Int>& dirty_nodes() const {
+            return dirty_nodes_;
+        }
+
+        void ClearDirtyNodes() {
+            for (Int node : dirty_nodes_)
+                dirty_[node] = false;
+            dirty_nodes_.clear();
+        }
+
     protected:
+        void MarkDirty(Int node) {
+            if (dirty_[node])
+                return;
+            dirty_[node] = true;
+            dirty_nodes_.push_back(node);
+        }
+
         Int num_routes_ = 0;
         Int num_nodes_ = 0;
         Int num_visited_nodes_ = 0;
         std::vector<Int> node_to_route_;
         std::vector<Int> lasts_;
         std::vector<Int> nexts_;
+        // The nodes whose links have changed, which the searches use to re-evaluate only the moves around them.
+        std::vector<char> dirty_;
+        std::vector<Int> dirty_nodes_;
     };
 }
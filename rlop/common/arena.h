@@ -0,0 +1,139 @@
+#pragma once
+#include <memory>
+#include "typedef.h"
+
+namespace rlop {
+    // A non-owning view of a contiguous range of elements, typically allocated from an Arena. It mirrors
+    // the element access part of the std::vector interface so that it can replace per-object vectors whose
+    // size is fixed once allocated.
+    template<typename T>
+    class ArenaSpan {
+    public:
+        ArenaSpan() = default;
+
+        ArenaSpan(T* data, size_t size) : data_(data), size_(size) {}
+
+        T& operator[](size_t i) const {
+            return data_[i];
+        }
+
+        void clear() {
+            data_ = nullptr;
+            size_ = 0;
+        }
+
+        bool empty() const {
+            return size_ == 0;
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+        T* data() const {
+            return data_;
+        }
+
+        T* begin() const {
+            return data_;
+        }
+
+        T* end() const {
+            return data_ + size_;
+        }
+
+    private:
+        T* data_ = nullptr;
+        size_t size_ = 0;
+    };
+
+    // A slab allocator that hands out contiguous ranges of value-initialized elements from fixed-size slabs.
+    // Elements are never freed individually. Instead, Reset() rewinds the arena in O(1) and the slabs are
+    // reused by subsequent allocations, which makes it suitable for short-lived structures such as search
+    // trees that are discarded as a whole. Pointers remain valid until the next Reset().
+    //
+    // Template Parameters:
+    //   T: The element type. Must be trivially destructible since destructors are never run.
+    template<typename T>
+    class Arena {
+    public:
+        static_assert(std::is_trivially_destructible_v<T>, "Arena: element type should be trivially destructible.");
+
+        // Parameters:
+        //   slab_size: The number of elements per slab. Requests larger than this get a dedicated slab.
+        Arena(size_t slab_size = 4096) : slab_size_(slab_size) {}
+
+        // Rewinds the arena, invalidating all the elements allocated so far while keeping the slabs.
+        void Reset() {
+            slab_i_ = 0;
+            offset_ = 0;
+            size_ = 0;
+        }
+
+        // Releases all the slabs.
+        void Clear() {
+            Reset();
+            slabs_.clear();
+        }
+
+        // Allocates a contiguous range of value-initialized elements.
+        //
+        // Parameters:
+        //   n: The number of elements.
+        //
+        // Returns:
+        //   T*: Pointer to the first element of the range.
+        T* Allocate(size_t n = 1) {
+            while (slab_i_ < slabs_.size() && offset_ + n > slabs_[slab_i_].size) {
+                ++slab_i_;
+                offset_ = 0;
+            }
+            if (slab_i_ == slabs_.size()) {
+                size_t size = std::max(slab_size_, n);
+                slabs_.push_back({ std::make_unique<T[]>(size), size });
+                offset_ = 0;
+            }
+            T* ptr = slabs_[slab_i_].data.get() + offset_;
+            for (size_t i=0; i<n; ++i) {
+                new (ptr + i) T();
+            }
+            offset_ += n;
+            size_ += n;
+            return ptr;
+        }
+
+        ArenaSpan<T> AllocateSpan(size_t n) {
+            return { Allocate(n), n };
+        }
+
+        // Returns the number of elements allocated since the last Reset().
+        size_t size() const {
+            return size_;
+        }
+
+        // Returns the total number of elements held by the slabs.
+        size_t capacity() const {
+            size_t capacity = 0;
+            for (const auto& slab : slabs_) {
+                capacity += slab.size;
+            }
+            return capacity;
+        }
+
+        size_t slab_size() const {
+            return slab_size_;
+        }
+
+    private:
+        struct Slab {
+            std::unique_ptr<T[]> data;
+            size_t size = 0;
+        };
+
+        size_t slab_size_;
+        size_t slab_i_ = 0;
+        size_t offset_ = 0;
+        size_t size_ = 0;
+        std::vector<Slab> slabs_;
+    };
+}
@@ -18,6 +18,10 @@
 #include <unordered_set>
 #include <bitset>
 #include <optional>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <cstring>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -1,5 +1,5 @@
 #pragma once
-#include "lib.h"
+#include "typedef.h"
 
 #if defined(__GNUC__)
 #include <unistd.h>
@@ -13,11 +13,119 @@
 #define NOMINMAX
 #include <windows.h>
 #include <psapi.h>
+#include <xmmintrin.h>
 #else
 #include <sys/time.h>
 #endif
 
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 namespace rlop {
+   // Hints the processor to load the cache line of an address, e.g., of a hash table slot probed shortly afterwards.
+   inline void Prefetch(const void* addr) {
+#if defined(__GNUC__)
+      __builtin_prefetch(addr);
+#elif defined(_MSC_VER)
+      _mm_prefetch(static_cast<const char*>(addr), _MM_HINT_T0);
+#endif
+   }
+
+   // Maps a file into memory read-only, so that a large table on disk can be probed without reading it as a whole. The
+   // pages are loaded by the OS on demand and shared by all the processes mapping the same file.
+   class MappedFile {
+   public:
+      MappedFile() = default;
+
+      virtual ~MappedFile() {
+         Close();
+      }
+
+      DISALLOW_COPY_AND_ASSIGN(MappedFile);
+
+      // Maps a file, unmapping the previous one.
+      //
+      // Parameters:
+      //   path: The path of the file.
+      //
+      // Returns:
+      //   bool: Returns false if the file cannot be opened or mapped, or is empty.
+      bool Open(const std::string& path) {
+         Close();
+#if defined(_WIN32)
+         HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+         if (file == INVALID_HANDLE_VALUE)
+            return false;
+         LARGE_INTEGER size;
+         if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+         }
+         HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+         CloseHandle(file);
+         if (mapping == NULL)
+            return false;
+         void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+         CloseHandle(mapping);
+         if (data == NULL)
+            return false;
+         size_ = static_cast<size_t>(size.QuadPart);
+#else
+         int fd = open(path.c_str(), O_RDONLY);
+         if (fd < 0)
+            return false;
+         struct stat st;
+         if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            close(fd);
+            return false;
+         }
+         void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+         close(fd);
+         if (data == MAP_FAILED)
+            return false;
+         size_ = static_cast<size_t>(st.st_size);
+#endif
+         data_ = static_cast<const char*>(data);
+         return true;
+      }
+
+      void Close() {
+         if (data_ == nullptr)
+            return;
+#if defined(_WIN32)
+         UnmapViewOfFile(data_);
+#else
+         munmap(const_cast<char*>(data_), size_);
+#endif
+         data_ = nullptr;
+         size_ = 0;
+      }
+
+      bool IsOpen() const {
+         return data_ != nullptr;
+      }
+
+      const char* data() const {
+         return data_;
+      }
+
+      size_t size() const {
+         return size_;
+      }
+
+   private:
+      const char* data_ = nullptr;
+      size_t size_ = 0;
+   };
+
    inline std::string GetDatetime(const std::string& format = "%Y%m%d_%H%M%S") {
       auto time_t = std::time(nullptr);
       struct std::tm* timeinfo = std::localtime(&time_t);
@@ -28,6 +28,22 @@ namespace rlop {
             }
         }
 
+        // Returns a uniformly distributed integer in [0, n) by the multiply-shift reduction of a single 64-bit draw.
+        // Unlike Uniform(), it needs no distribution object and no division, at the cost of a bias of at most n / 2^64,
+        // which makes it suitable for hot loops such as random playouts.
+        //
+        // Parameters:
+        //   n: The number of values, which should be positive.
+        template <typename T>
+        T UniformIndex(T n) {
+            static_assert(std::is_integral_v<T>, "Random: uniform index requires an integral type.");
+#if defined(__SIZEOF_INT128__)
+            return static_cast<T>((static_cast<unsigned __int128>(gen_()) * static_cast<uint64_t>(n)) >> 64);
+#else
+            return static_cast<T>(gen_() % static_cast<uint64_t>(n));
+#endif
+        }
+
         template <typename T>
         T Normal(T mean, T std) {
             static_assert(std::is_arithmetic_v<T>, "Random: normal requires an arithmetic type.");
@@ -34,6 +34,14 @@ namespace rlop {
             return duration_;
         }
 
+        // Returns the accumulated duration including the current run, without stopping the timer.
+        int64_t Elapsed() const {
+            if (!running_)
+                return duration_;
+            auto const now = std::chrono::high_resolution_clock::now();
+            return duration_ + std::chrono::duration_cast<T> (now - start_).count();
+        }
+
         int64_t duration() const {
             return duration_;
         } 
@@ -17,7 +17,11 @@ namespace rlop {
         // Parameters:
         //   max_num_unimproved_iters: The maximum number of consecutive iterations without improvement
         //   before the search is terminated.
-        TabuSearch(Int max_num_unimproved_iters) : max_num_unimproved_iters_(max_num_unimproved_iters) {} 
+        //   num_threads: The number of threads evaluating the neighbors in Select(), defaulted to 1.
+        TabuSearch(Int max_num_unimproved_iters, Int num_threads = 1) : 
+            max_num_unimproved_iters_(max_num_unimproved_iters),
+            num_threads_(num_threads)
+        {} 
 
         virtual ~TabuSearch() = default;
         
@@ -50,22 +54,28 @@ namespace rlop {
             return num_unimproved_iters_ < max_num_unimproved_iters_;
         }
 
-        // Selects the next neighbor to consider, avoiding tabu neighbors unless it improves the best known cost.
+        // Selects the next neighbor to consider, avoiding tabu neighbors unless it improves the best known cost. With
+        // more than one thread, the neighbors are split into contiguous ranges evaluated in parallel, so EvaluateNeighbor()
+        // and IsTabu() should be safe to call concurrently. The best neighbors of the ranges are merged in order, so the
+        // neighbor of the lowest cost and then the lowest index is selected, the same as with one thread.
         virtual std::optional<Int> Select() override {
-            Int best = kIntNull;
-            double best_cost = std::numeric_limits<double>::max();
-            for (Int i=0; i<NumNeighbors(); ++i) {
-                double cost = EvaluateNeighbor(i);
-                if (cost >= this->best_cost_ && IsTabu(i))
-                    continue;
-                if (cost < best_cost) {
-                    best = i;
-                    best_cost = cost;
+            Int num_neighbors = NumNeighbors();
+            std::pair<Int, double> best = { kIntNull, std::numeric_limits<double>::max() };
+            if (num_threads_ <= 1 || num_neighbors < num_threads_)
+                best = SelectRange(0, num_neighbors);
+            else {
+                std::vector<std::pair<Int, double>> bests(num_threads_);
+                #pragma omp parallel for num_threads(num_threads_) schedule(static, 1)
+                for (Int i=0; i<num_threads_; ++i)
+                    bests[i] = SelectRange(num_neighbors * i / num_threads_, num_neighbors * (i + 1) / num_threads_);
+                for (const auto& range_best : bests) {
+                    if (range_best.first != kIntNull && range_best.second < best.second)
+                        best = range_best;
                 }
             }
-            if (best == kIntNull)
+            if (best.first == kIntNull)
                 return std::nullopt;
-            return { best };
+            return { best.first };
         }
 
         virtual void Improved() override {
@@ -85,8 +95,38 @@ namespace rlop {
             return max_num_unimproved_iters_;
         }
 
+        Int num_threads() const {
+            return num_threads_;
+        }
+
+        void set_num_threads(Int num_threads) {
+            num_threads_ = num_threads;
+        }
+
     protected:
+        // Selects the first neighbor of the lowest cost in a range of neighbors, avoiding tabu neighbors unless it
+        // improves the best known cost.
+        //
+        // Returns:
+        //   std::pair<Int, double>: The index and the cost of the neighbor. The index is kIntNull if no neighbor of the
+        //                           range can be selected.
+        std::pair<Int, double> SelectRange(Int begin, Int end) {
+            Int best = kIntNull;
+            double best_cost = std::numeric_limits<double>::max();
+            for (Int i=begin; i<end; ++i) {
+                double cost = EvaluateNeighbor(i);
+                if (cost >= this->best_cost_ && IsTabu(i))
+                    continue;
+                if (cost < best_cost) {
+                    best = i;
+                    best_cost = cost;
+                }
+            }
+            return { best, best_cost };
+        }
+
         Int num_unimproved_iters_ = 0;
         Int max_num_unimproved_iters_;
+        Int num_threads_;
     };
 }
\ No newline at end of file
@@ -0,0 +1,318 @@
+#pragma once
+#include "rlop/common/base_algorithm.h"
+#include "rlop/common/timer.h"
+#include "rlop/common/arena.h"
+
+namespace rlop {
+    // Implements an AlphaZero-style PUCT search in which the priors and values of leaf nodes are provided by a model
+    // evaluated in batches, e.g., a libtorch model by TorchBatchedPUCT. Instead of querying the model once per node, the
+    // search descends the tree repeatedly, applying virtual losses along each path so that successive descents diverge,
+    // and records the observations of the pending leaves. Once the batch is full, or the oldest pending leaf has waited
+    // for longer than a timeout, all the leaves are evaluated at once. The priors are then cached on the leaf nodes and
+    // the values are backpropagated along the recorded paths.
+    //
+    // The descents run one after another in the calling thread, so the batching amortizes the cost of a model call
+    // rather than overlapping the descents, and the timeout is checked after each descent.
+    class BatchedPUCT : public BaseAlgorithm {
+    public:
+        struct Node {
+            double total_reward = 0;
+            Int num_visits = 0;
+            Int num_virtual_losses = 0; // The number of pending evaluations below the node.
+            ArenaSpan<Node*> children; // Allocated together with the priors once the node is evaluated.
+            ArenaSpan<float> priors;
+        };
+
+        // Constructs a BatchedPUCT with specified parameters.
+        //
+        // Parameters:
+        //   batch_size: The maximum number of leaves evaluated by a forward pass.
+        //   timeout: The maximum time in microseconds a pending leaf waits before the batch is evaluated.
+        //   coef: The exploration coefficient of the PUCT formula.
+        //   virtual_loss: The value deducted for each pending evaluation below a node.
+        BatchedPUCT(Int batch_size = 32, int64_t timeout = 1000, double coef = 1.25, double virtual_loss = 1.0) :
+            batch_size_(batch_size),
+            timeout_(timeout),
+            coef_(coef),
+            virtual_loss_(virtual_loss)
+        {}
+
+        virtual ~BatchedPUCT() = default;
+
+        // Pure virtual function to return the total number of child states from the current state.
+        virtual Int NumChildStates() const = 0;
+
+        // Pure virtual function to revert the environment state to the state at the beginning of the search.
+        virtual void RevertState() = 0;
+
+        // Pure virtual function to advance the environment state based on the selected child index.
+        //
+        // Parameters:
+        //   child_i: The index of the child to move to.
+        //
+        // Return:
+        //   bool: Returns false if the step was unsuccessful or the resulting state is terminal.
+        virtual bool Step(Int child_i) = 0;
+
+        // Pure virtual function to return the reward of a terminal state. A state without child states is terminal.
+        virtual double Reward() = 0;
+
+        // Pure virtual function to record the observation of the current state as the observation of a pending leaf.
+        //
+        // Parameters:
+        //   leaf_i: The index of the leaf in the batch. The leaves of a batch are observed in the order of the indices.
+        virtual void ObserveLeaf(Int leaf_i) = 0;
+
+        // Pure virtual function to evaluate the observations of the pending leaves with the model.
+        //
+        // Parameters:
+        //   num_leaves: The number of the pending leaves.
+        //   priors: Output, the prior probabilities of the leaves as num_leaves rows of the same width. The first
+        //           NumChildStates() entries of each row are used for the children of the corresponding leaf.
+        //   values: Output, the values of the leaves, on the same scale as Reward().
+        virtual void PredictLeaves(Int num_leaves, std::vector<float>* priors, std::vector<float>* values) = 0;
+
+        // Resets the algorithm.
+        virtual void Reset() override {
+            node_arena_.Reset();
+            child_arena_.Reset();
+            prior_arena_.Reset();
+            pending_.clear();
+            path_.clear();
+            root_ = node_arena_.Allocate();
+        }
+
+        // Performs the search over a maximum number of iterations, each of which backpropagates either a terminal
+        // reward or a value predicted by the model.
+        //
+        // Parameters:
+        //   max_num_iters: The maximum number of iterations.
+        virtual void Search(Int max_num_iters) {
+            num_iters_ = 0;
+            max_num_iters_ = max_num_iters;
+            while (Proceed()) {
+                RevertState();
+                path_ = { root_ };
+                if (!Select()) {
+                    BackPropagate(path_, Reward());
+                    ++num_iters_;
+                }
+                else if (IsPending(*path_.back())) {
+                    Flush();
+                    continue;
+                }
+                else
+                    Enqueue();
+                if (Int(pending_.size()) >= batch_size_ || (!pending_.empty() && batch_timer_.Elapsed() >= timeout_))
+                    Flush();
+            }
+            Flush();
+        }
+
+        // Checks if the search should continue. Pending leaves count towards the iterations.
+        virtual bool Proceed() {
+            return num_iters_ + Int(pending_.size()) < max_num_iters_;
+        }
+
+        // Descends from the root by the PUCT formula until reaching a node that has not been evaluated.
+        //
+        // Returns:
+        //   bool: Returns false if the descent ended in a terminal state, including a state without child states,
+        //         which is never evaluated by the model.
+        virtual bool Select() {
+            while (!path_.back()->priors.empty()) {
+                Node* node = path_.back();
+                Int child_i = SelectByTreePolicy(*node);
+                if (node->children[child_i] == nullptr)
+                    node->children[child_i] = node_arena_.Allocate();
+                path_.push_back(node->children[child_i]);
+                if (!Step(child_i))
+                    return false;
+            }
+            return NumChildStates() > 0;
+        }
+
+        // Computes the PUCT score of a child node, counting the pending evaluations below the child as losses.
+        //
+        // Parameters:
+        //   node: The parent node.
+        //   child_i: The index of the child node.
+        //
+        // Return:
+        //   double: the score of the child node.
+        virtual double TreePolicy(const Node& node, Int child_i) const {
+            const Node* child = node.children[child_i];
+            double q_value = 0;
+            Int num_visits = 0;
+            if (child != nullptr) {
+                num_visits = child->num_visits + child->num_virtual_losses;
+                if (num_visits > 0)
+                    q_value = (child->total_reward - child->num_virtual_losses * virtual_loss_) / num_visits;
+            }
+            Int total_num_visits = node.num_visits + node.num_virtual_losses;
+            return q_value + coef_ * node.priors[child_i] * std::sqrt((double)total_num_visits) / (1.0 + num_visits);
+        }
+
+        virtual Int SelectByTreePolicy(const Node& node) const {
+            Int best = 0;
+            double best_score = std::numeric_limits<double>::lowest();
+            Int num_children = node.children.size();
+            for (Int i=0; i<num_children; ++i) {
+                double score = TreePolicy(node, i);
+                if (score > best_score) {
+                    best = i;
+                    best_score = score;
+                }
+            }
+            return best;
+        }
+
+        // Adds the reward of a node at a given depth of a path. Override it to convert the reward to the perspective
+        // of the player to move at the parent node in multi-player games.
+        //
+        // Parameters:
+        //   node: The node to update.
+        //   depth: The depth of the node in the path, where the root is at depth 0.
+        //   reward: The reward from the perspective used by Reward() and Predict().
+        virtual void UpdateNode(Node* node, Int, double reward) const {
+            node->total_reward += reward;
+            node->num_visits += 1;
+        }
+
+        // Backpropagates a reward through a path.
+        virtual void BackPropagate(const std::vector<Node*>& path, double reward) {
+            for (Int i=path.size()-1; i>=0; --i) {
+                UpdateNode(path[i], i, reward);
+            }
+        }
+
+        // Evaluates the pending leaves with a single call of PredictLeaves(), caches the priors on the leaves and
+        // backpropagates the values. Throws std::runtime_error if the outputs do not have a value for each leaf and a
+        // row of priors covering the children of each leaf.
+        virtual void Flush() {
+            batch_timer_.Reset();
+            if (pending_.empty())
+                return;
+            Int num_leaves = pending_.size();
+            Int max_num_children = 0;
+            for (const auto& leaf : pending_) {
+                max_num_children = std::max(max_num_children, leaf.num_children);
+            }
+            priors_.clear();
+            values_.clear();
+            PredictLeaves(num_leaves, &priors_, &values_);
+            if (Int(values_.size()) != num_leaves)
+                throw std::runtime_error("BatchedPUCT: expected " + std::to_string(num_leaves) + " values, got " + std::to_string(values_.size()) + ".");
+            Int num_priors = priors_.size();
+            if (num_priors % num_leaves != 0 || num_priors / num_leaves < max_num_children)
+                throw std::runtime_error("BatchedPUCT: expected " + std::to_string(num_leaves) + " rows of at least " + std::to_string(max_num_children) + " priors, got " + std::to_string(num_priors) + " priors.");
+            Int width = num_priors / num_leaves;
+            for (Int i=0; i<num_leaves; ++i) {
+                auto& leaf = pending_[i];
+                Node* node = leaf.path.back();
+                node->children = child_arena_.AllocateSpan(leaf.num_children);
+                node->priors = prior_arena_.AllocateSpan(leaf.num_children);
+                for (Int j=0; j<leaf.num_children; ++j) {
+                    node->priors[j] = priors_[i * width + j];
+                }
+                for (Node* n : leaf.path) {
+                    --n->num_virtual_losses;
+                }
+                BackPropagate(leaf.path, values_[i]);
+            }
+            num_iters_ += pending_.size();
+            pending_.clear();
+        }
+
+        // Returns the index of the most visited child of the root, or std::nullopt if the root has not been evaluated.
+        std::optional<Int> SelectMostVisited() const {
+            Int best = kIntNull;
+            Int best_num_visits = -1;
+            Int num_children = root_->children.size();
+            for (Int i=0; i<num_children; ++i) {
+                const Node* child = root_->children[i];
+                if (child != nullptr && child->num_visits > best_num_visits) {
+                    best = i;
+                    best_num_visits = child->num_visits;
+                }
+            }
+            if (best == kIntNull)
+                return std::nullopt;
+            return { best };
+        }
+
+        const Node* root() const {
+            return root_;
+        }
+
+        Int batch_size() const {
+            return batch_size_;
+        }
+
+        int64_t timeout() const {
+            return timeout_;
+        }
+
+        double coef() const {
+            return coef_;
+        }
+
+        double virtual_loss() const {
+            return virtual_loss_;
+        }
+
+        void set_batch_size(Int batch_size) {
+            batch_size_ = batch_size;
+        }
+
+        void set_timeout(int64_t timeout) {
+            timeout_ = timeout;
+        }
+
+        void set_coef(double coef) {
+            coef_ = coef;
+        }
+
+        void set_virtual_loss(double virtual_loss) {
+            virtual_loss_ = virtual_loss;
+        }
+
+    protected:
+        struct PendingLeaf {
+            std::vector<Node*> path;
+            Int num_children = 0;
+        };
+
+        // Returns true if the node is a leaf waiting in the current batch.
+        static bool IsPending(const Node& node) {
+            return node.priors.empty() && node.num_virtual_losses > 0;
+        }
+
+        // Applies virtual losses along the current path and adds its leaf to the batch.
+        void Enqueue() {
+            if (pending_.empty())
+                batch_timer_.Restart();
+            for (Node* node : path_) {
+                ++node->num_virtual_losses;
+            }
+            ObserveLeaf(pending_.size());
+            pending_.push_back({ path_, NumChildStates() });
+        }
+
+        Int batch_size_;
+        int64_t timeout_;
+        double coef_;
+        double virtual_loss_;
+        Int num_iters_ = 0;
+        Int max_num_iters_ = 0;
+        Node* root_ = nullptr;
+        std::vector<Node*> path_;
+        std::vector<PendingLeaf> pending_;
+        std::vector<float> priors_;
+        std::vector<float> values_;
+        Timer<std::chrono::microseconds> batch_timer_;
+        Arena<Node> node_arena_;
+        Arena<Node*> child_arena_{ 1 << 14 };
+        Arena<float> prior_arena_{ 1 << 14 };
+    };
+}
@@ -2,17 +2,31 @@
 #include "rlop/common/base_algorithm.h"
 #include "rlop/common/utils.h"
 #include "rlop/common/random.h"
+#include "rlop/common/arena.h"
+#include "rlop/common/timer.h"
+#include "mcts_stats.h"
 
 namespace rlop {
     // Implements the Monte Carlo Tree Search (MCTS) algorithm for decision making in domains
-    // with discrete action spaces.
+    // with discrete action spaces. Nodes and their child arrays are allocated from arenas, so
+    // the whole tree is released in O(1) when the search is reset. The search is anytime: it can
+    // be bounded by a time limit, interrupted from another thread by Stop(), and the current best
+    // child of the root can be queried while it runs. In the transposition mode, nodes are shared
+    // between the move orders that reach the same state, so the tree becomes a directed acyclic graph.
+    // In the progressive widening mode, the children of a node are materialized one at a time as its
+    // visits grow, so the memory of a node is proportional to the children actually explored rather
+    // than to the branching factor.
     class MCTS : public BaseAlgorithm {
     public:
         struct Node {
             double mean_reward = 0;
             Int num_visits = 0;
             Int num_children = 0; // The number of children nodes expanded.
-            std::vector<Node*> children;
+            ArenaSpan<Node*> children; // Contiguous child slots in the child arena.
+            ArenaSpan<Int> actions; // The child states of the slots in the progressive widening mode, where the slots
+                                    // are filled in the order of widening. Empty if slot i holds child state i.
+            ArenaSpan<float> priors; // Prior probabilities of the children, filled at expansion by PUCT.
+            uint64_t key = 0; // The state key in the transposition mode, or 0 if the node is not shared.
         };
         
         // Constructs an MCTS with a exploration coefficient.
@@ -44,70 +58,256 @@ namespace rlop {
         // Pure virtual function to return the reward of the current state. 
         virtual double Reward() = 0;
 
+        // Returns a key identifying the current state, used to share nodes in the transposition mode. States reached
+        // by different move orders should have the same key, and the states should not repeat along a path. The
+        // default returns 0, which means the state is never shared.
+        virtual uint64_t StateKey() {
+            return 0;
+        }
+
         // Resets the algorithm.
         virtual void Reset() override {
-            if (!path_.empty()) {
+            if (!path_.empty())
                 Release(path_[0]);
-                delete path_[0];
-            }
+            node_arena_.Reset();
+            child_arena_.Reset();
+            action_arena_.Reset();
+            prior_arena_.Reset();
+            table_.clear();
             path_ = { NewNode() };
+            best_child_ = kIntNull;
+            stopped_ = false;
+        }
+
+        // Promotes a child of the root to the new root, keeping the statistics of its subtree and releasing the
+        // sibling subtrees, so that consecutive searches start warm. The state that RevertState() reverts to should
+        // be advanced by the same child. The kept subtree is compacted into a spare set of arenas, which are then
+        // swapped with the current ones. If the child has not been expanded, the tree is reset instead.
+        //
+        // Parameters:
+        //   child_i: The index of the child of the root.
+        //
+        // Returns:
+        //   bool: Returns true if the subtree of the child is reused.
+        virtual bool Advance(Int child_i) {
+            const Node* child = path_.empty()? nullptr : FindChild(*path_.front(), child_i);
+            if (child == nullptr) {
+                Reset();
+                return false;
+            }
+            spare_node_arena_.Reset();
+            spare_child_arena_.Reset();
+            spare_action_arena_.Reset();
+            spare_prior_arena_.Reset();
+            table_.clear();
+            std::unordered_map<const Node*, Node*> copies;
+            Node* root = CopySubtree(*child, &spare_node_arena_, &spare_child_arena_, &spare_action_arena_, &spare_prior_arena_, transposition_? &copies : nullptr);
+            std::swap(node_arena_, spare_node_arena_);
+            std::swap(child_arena_, spare_child_arena_);
+            std::swap(action_arena_, spare_action_arena_);
+            std::swap(prior_arena_, spare_prior_arena_);
+            for (const auto& [node, copy] : copies) {
+                if (copy->key != 0)
+                    table_.emplace(copy->key, copy);
+            }
+            path_ = { root };
+            UpdateBestChild();
+            stopped_ = false;
+            return true;
         }
 
         virtual void SetSeed(uint64_t seed) {
             rand_.Seed(seed);
         }
 
-        // Performs the MCTS search over a maximum number of iterations.
+        // Performs the MCTS search over a maximum number of iterations and an optional time limit. The clock is
+        // checked every check_interval() iterations, so the search may overrun the time limit by that many
+        // iterations.
         //
         // Parameters:
         //   max_num_iters: The maximum number of iterations.
-        virtual void Search(Int max_num_iters) {
+        //   time_limit: The time limit in milliseconds. Default is kIntFull, i.e., no limit.
+        virtual void Search(Int max_num_iters, int64_t time_limit = kIntFull) {
             num_iters_ = 0;
             max_num_iters_ = max_num_iters;
+            time_limit_ = time_limit;
+            stats_ = MCTSStats();
+            int64_t start = StatsClock();
+            timer_.Restart();
             while (Proceed()) {
                 RevertState();
-                if (Select() && Expand())
-                    Simulate();
-                BackPropagate();
+                if (TimePhase(&stats_.select_time, [&] { return Select(); }) && TimePhase(&stats_.expand_time, [&] { return Expand(); })) {
+                    TimePhase(&stats_.simulate_time, [&] { return Simulate(); });
+                    if constexpr (kMCTSStats)
+                        ++stats_.num_simulations;
+                }
+                if constexpr (kMCTSStats)
+                    stats_.max_depth = std::max(stats_.max_depth, Int(path_.size()) - 1);
+                TimePhase(&stats_.backpropagate_time, [&] { BackPropagate(); });
                 Update();
             }
+            timer_.Stop();
+            UpdateBestChild();
+            if constexpr (kMCTSStats) {
+                stats_.search_time = StatsClock() - start;
+                stats_.num_iters = num_iters_;
+                stats_.num_nodes = node_arena_.size();
+                stats_.memory = node_arena_.capacity() * sizeof(Node) + child_arena_.capacity() * sizeof(Node*) + 
+                    action_arena_.capacity() * sizeof(Int) + prior_arena_.capacity() * sizeof(float);
+            }
         }
 
-        // Checks if the search should continue.
+        // Checks if the search should continue. Besides the iteration budget and the stop flag, which are checked
+        // every iteration, the time limit and the early stopping rule are checked every check_interval() iterations.
         virtual bool Proceed() {
-            return num_iters_ < max_num_iters_; 
+            if (num_iters_ >= max_num_iters_ || stopped_.load(std::memory_order_relaxed))
+                return false;
+            if (num_iters_ % check_interval_ != 0)
+                return true;
+            UpdateBestChild();
+            if (time_limit_ != kIntFull && timer_.Elapsed() >= time_limit_)
+                return false;
+            return !(early_stop_ && IsDecided());
+        }
+
+        // Interrupts the search at the next iteration. It is safe to call from another thread. A stop that arrives before
+        // the search starts is kept, so the search returns at once. The flag is cleared by Reset() and Advance(), which
+        // set up the next search.
+        void Stop() {
+            stopped_.store(true, std::memory_order_relaxed);
+        }
+
+        // Checks whether the most visited child of the root can no longer be overtaken within the remaining budget.
+        // Each iteration visits at most one child of the root, so the decision is final once the lead in visits
+        // exceeds the number of remaining iterations. Under a time limit, the remaining iterations are estimated from
+        // the rate of the search so far.
+        //
+        // Returns:
+        //   bool: Returns true if the remaining budget cannot change the most visited child of the root.
+        virtual bool IsDecided() const {
+            if (path_.empty())
+                return false;
+            Int first = 0;
+            Int second = 0;
+            for (const Node* child : path_.front()->children) {
+                Int num_visits = child == nullptr ? 0 : child->num_visits;
+                if (num_visits > first) {
+                    second = first;
+                    first = num_visits;
+                }
+                else if (num_visits > second) {
+                    second = num_visits;
+                }
+            }
+            Int num_remaining_iters = max_num_iters_ - num_iters_;
+            if (time_limit_ != kIntFull) {
+                int64_t elapsed = timer_.Elapsed();
+                if (elapsed <= 0)
+                    return false;
+                num_remaining_iters = std::min(num_remaining_iters, Int(num_iters_ * std::max(int64_t(0), time_limit_ - elapsed) / elapsed));
+            }
+            return first - second > num_remaining_iters;
+        }
+
+        // Returns the most visited child of the root as of the last check of the search. It is safe to call from
+        // another thread while the search runs.
+        //
+        // Returns:
+        //   std::optional<Int>: The index of the child state, or std::nullopt if the root has no visited children.
+        std::optional<Int> BestChild() const {
+            Int best = best_child_.load(std::memory_order_relaxed);
+            if (best == kIntNull)
+                return std::nullopt;
+            return { best };
         }
 
-        // Selects the next node to explore in the tree based on the tree policy.
+        // Selects the next node to explore in the tree based on the tree policy. In the progressive widening mode, the
+        // descent stops at the first node that may be widened, instead of the first node that is not fully expanded.
         virtual bool Select() {
             if (path_.empty())
                 return true;
-            while (IsExpanded(*path_.back())) {
+            while (widening_? IsWidened(*path_.back()) : IsExpanded(*path_.back())) {
                 auto child_i = SelectByTreePolicy();
                 if (!child_i)
                     return false;
-                path_.push_back(path_.back()->children[*child_i]); 
-                if (!Step(*child_i)) 
+                Node* node = path_.back();
+                path_.push_back(node->children[*child_i]); 
+                if (!Step(ChildState(*node, *child_i))) 
                     return false;
             }
             return true;
         }
 
+        // Checks whether the current node has as many children as the progressive widening allows for its visits, i.e.,
+        // min(NumChildStates(), ceil(widening_coef * (num_visits + 1)^widening_exponent)).
+        //
+        // Parameters:
+        //   node: The current node.
+        virtual bool IsWidened(const Node& node) const {
+            Int max_num_children = std::max(Int(1), Int(std::ceil(widening_coef_ * std::pow(node.num_visits + 1.0, widening_exponent_))));
+            return node.num_children >= std::min(NumChildStates(), max_num_children);
+        }
+
         // Expands the current node by adding a new child node to the tree.
         virtual bool Expand() {
+            if (widening_)
+                return Widen();
             if (path_.back()->children.empty())
-                path_.back()->children = std::vector<Node*>(NumChildStates());
+                path_.back()->children = child_arena_.AllocateSpan(NumChildStates());
             if (path_.back()->children.empty())
                 return false;
             auto child_i = SelectToExpand();
             if (!child_i)
                 return false;
-            if (path_.back()->children[*child_i] == nullptr) {
-                path_.back()->children[*child_i] = NewNode();
-                ++path_.back()->num_children;
+            Node* node = path_.back();
+            bool stepped = Step(*child_i);
+            if (node->children[*child_i] == nullptr) {
+                node->children[*child_i] = transposition_? FindOrNewNode() : NewNode();
+                ++node->num_children;
             }
-            path_.push_back(path_.back()->children[*child_i]);
-            return Step(*child_i);
+            path_.push_back(node->children[*child_i]);
+            return stepped;
+        }
+
+        // Adds the child state selected by SelectToWiden() to the current node in the progressive widening mode and
+        // moves to it. The child slots of the node grow geometrically, so the slots abandoned in the arena take at most
+        // as much memory as the ones in use.
+        virtual bool Widen() {
+            Node* node = path_.back();
+            Int num_child_states = NumChildStates();
+            if (node->num_children >= num_child_states)
+                return false;
+            auto child_i = SelectToWiden();
+            if (!child_i)
+                return false;
+            Int slot = AddChildSlot(node, *child_i, num_child_states);
+            bool stepped = Step(*child_i);
+            node->children[slot] = transposition_? FindOrNewNode() : NewNode();
+            path_.push_back(node->children[slot]);
+            return stepped;
+        }
+
+        // Appends a slot for a child state to a node in the progressive widening mode, growing the slots if needed.
+        //
+        // Parameters:
+        //   node: The node to widen.
+        //   child_i: The index of the child state.
+        //   num_child_states: The total number of child states of the node.
+        //
+        // Returns:
+        //   Int: The index of the new slot.
+        virtual Int AddChildSlot(Node* node, Int child_i, Int num_child_states) {
+            if (node->num_children == node->children.size()) {
+                Int capacity = std::min(num_child_states, std::max(Int(4), 2 * node->num_children));
+                auto children = child_arena_.AllocateSpan(capacity);
+                auto actions = action_arena_.AllocateSpan(capacity);
+                std::copy(node->children.begin(), node->children.end(), children.begin());
+                std::copy(node->actions.begin(), node->actions.end(), actions.begin());
+                node->children = children;
+                node->actions = actions;
+            }
+            node->actions[node->num_children] = child_i;
+            return node->num_children++;
         }
 
         // Simulates the outcome from the current state to the end of the episode.
@@ -121,7 +321,14 @@ namespace rlop {
 
         // Backpropagates the simulation results through the path in the tree.
         virtual void BackPropagate() {
-            double reward = Reward();
+            BackPropagate(Reward());
+        }
+
+        // Backpropagates a reward through the path in the tree.
+        //
+        // Parameters:
+        //   reward: The reward of the simulation.
+        virtual void BackPropagate(double reward) {
             while (path_.size() > 1) {
                 UpdateNode(reward);
                 path_.pop_back();
@@ -133,19 +340,35 @@ namespace rlop {
             ++num_iters_;
         }
 
+        // Detaches the subtree of a node. The memory is reclaimed in bulk when the arenas are reset.
         virtual void Release(Node* node) {
             if (node == nullptr) 
                 return;
-            for (Int i=0; i<node->children.size(); ++i) {
-                Node* child = node->children[i];
-                Release(child);
-                delete child;
-            }
             node->children.clear();
+            node->actions.clear();
+            node->num_children = 0;
         }
 
         virtual Node* NewNode() const {
-            return new Node();
+            return node_arena_.Allocate();
+        }
+
+        // Returns the node shared by the current state in the transposition mode, allocating and registering a new node
+        // if the state has not been reached before. A node already on the current path is never returned, so a step that
+        // leaves the state unchanged does not create a cycle.
+        virtual Node* FindOrNewNode() {
+            uint64_t key = StateKey();
+            if (key == 0)
+                return NewNode();
+            auto [it, inserted] = table_.try_emplace(key, nullptr);
+            if (!inserted && std::find(path_.begin(), path_.end(), it->second) == path_.end())
+                return it->second;
+            Node* node = NewNode();
+            if (inserted) {
+                node->key = key;
+                it->second = node;
+            }
+            return node;
         }
 
         virtual void UpdateNode(double reward) const {
@@ -198,7 +421,27 @@ namespace rlop {
         virtual std::optional<Int> SelectToExpand() {
             if (path_.back()->children.empty())
                 return std::nullopt;
-            return { rand_.Uniform(size_t(0), path_.back()->children.size() - 1) };
+            return { rand_.UniformIndex(Int(path_.back()->children.size())) };
+        }
+
+        // Selects the child state to add to the current node in the progressive widening mode, among the child states
+        // that have not been added yet. The default selects one uniformly at random.
+        //
+        // Returns:
+        //   std::optional<Int>: The index of the child state. If all the child states have been added, returns
+        //                       std::nullopt.
+        virtual std::optional<Int> SelectToWiden() {
+            const Node& node = *path_.back();
+            Int num_child_states = NumChildStates();
+            if (node.num_children >= num_child_states)
+                return std::nullopt;
+            MarkChildStates(node, num_child_states);
+            Int rank = rand_.UniformIndex(num_child_states - node.num_children);
+            for (Int i=0; i<num_child_states; ++i) {
+                if (!child_state_marks_[i] && rank-- == 0)
+                    return { i };
+            }
+            return std::nullopt;
         }
 
         // Selects a child state randomly from the current state. This method is used during the simulation phase.
@@ -210,26 +453,191 @@ namespace rlop {
             Int num_children = NumChildStates();
             if (num_children <= 0)
                 return std::nullopt;
-            return { rand_.Uniform(Int(0), num_children - 1) };
+            return { rand_.UniformIndex(num_children) };
         }
 
         const std::vector<Node*>& path() const {
             return path_;
         }
 
+        // Returns the index of the child state held by a slot of a node.
+        static Int ChildState(const Node& node, Int slot) {
+            return node.actions.empty()? slot : node.actions[slot];
+        }
+
+        // Returns the child of a node for a child state, or nullptr if it has not been added.
+        //
+        // Parameters:
+        //   node: The parent node.
+        //   child_i: The index of the child state.
+        static Node* FindChild(const Node& node, Int child_i) {
+            if (node.actions.empty())
+                return child_i >= 0 && child_i < node.children.size()? node.children[child_i] : nullptr;
+            for (Int i=0; i<node.num_children; ++i) {
+                if (node.actions[i] == child_i)
+                    return node.children[i];
+            }
+            return nullptr;
+        }
+
+        // Returns the number of nodes allocated since the last reset.
+        Int num_nodes() const {
+            return node_arena_.size();
+        }
+
+        bool transposition() const {
+            return transposition_;
+        }
+
+        // Returns the statistics of the last search, which are collected only when RLOP_MCTS_STATS is defined.
+        const MCTSStats& stats() const {
+            return stats_;
+        }
+
+        bool widening() const {
+            return widening_;
+        }
+
+        double widening_coef() const {
+            return widening_coef_;
+        }
+
+        double widening_exponent() const {
+            return widening_exponent_;
+        }
+
         double coef() const {
             return coef_;
         }
 
+        Int num_iters() const {
+            return num_iters_;
+        }
+
+        Int check_interval() const {
+            return check_interval_;
+        }
+
+        bool early_stop() const {
+            return early_stop_;
+        }
+
         void set_coef(double coef) {
             coef_ = coef;
         }
 
+        // Enables the transposition mode, in which nodes are shared by the states with the same StateKey(). It should
+        // be set before the tree is built.
+        void set_transposition(bool transposition) {
+            transposition_ = transposition;
+        }
+
+        // Enables the progressive widening mode, in which a node with n visits has at most
+        // ceil(coef * (n + 1)^exponent) children. It should be set before the tree is built.
+        //
+        // Parameters:
+        //   widening: Whether to enable the mode.
+        //   coef: The widening coefficient. Default is 1.
+        //   exponent: The widening exponent, typically in (0, 1). Default is 0.5.
+        void set_widening(bool widening, double coef = 1.0, double exponent = 0.5) {
+            widening_ = widening;
+            widening_coef_ = coef;
+            widening_exponent_ = exponent;
+        }
+
+        void set_check_interval(Int check_interval) {
+            check_interval_ = std::max(Int(1), check_interval);
+        }
+
+        // Enables stopping the search once the most visited child of the root is decided. See IsDecided().
+        void set_early_stop(bool early_stop) {
+            early_stop_ = early_stop;
+        }
+
     protected:
+        // Marks the child states that have been added to a node in child_state_marks_.
+        void MarkChildStates(const Node& node, Int num_child_states) {
+            child_state_marks_.assign(num_child_states, 0);
+            for (Int i=0; i<node.num_children; ++i) {
+                if (node.actions[i] < num_child_states)
+                    child_state_marks_[node.actions[i]] = 1;
+            }
+        }
+
+        // Publishes the most visited child of the root for BestChild().
+        void UpdateBestChild() {
+            Int best = kIntNull;
+            Int best_num_visits = 0;
+            if (!path_.empty()) {
+                const auto& children = path_.front()->children;
+                for (Int i=0; i<children.size(); ++i) {
+                    if (children[i] != nullptr && children[i]->num_visits > best_num_visits) {
+                        best = ChildState(*path_.front(), i);
+                        best_num_visits = children[i]->num_visits;
+                    }
+                }
+            }
+            best_child_.store(best, std::memory_order_relaxed);
+        }
+
+        // Copies the subtree rooted at a node into the given arenas. When a map of the copied nodes is given, shared nodes
+        // are copied once and the map is filled with the copy of each node.
+        //
+        // Returns:
+        //   Node*: The copy of the node.
+        Node* CopySubtree(const Node& node, Arena<Node>* node_arena, Arena<Node*>* child_arena, Arena<Int>* action_arena, Arena<float>* prior_arena, std::unordered_map<const Node*, Node*>* copies) const {
+            if (copies != nullptr) {
+                auto it = copies->find(&node);
+                if (it != copies->end())
+                    return it->second;
+            }
+            Node* copy = node_arena->Allocate();
+            *copy = node;
+            if (copies != nullptr)
+                copies->emplace(&node, copy);
+            if (!node.priors.empty()) {
+                copy->priors = prior_arena->AllocateSpan(node.priors.size());
+                std::copy(node.priors.begin(), node.priors.end(), copy->priors.begin());
+            }
+            if (!node.actions.empty()) {
+                copy->actions = action_arena->AllocateSpan(node.actions.size());
+                std::copy(node.actions.begin(), node.actions.end(), copy->actions.begin());
+            }
+            if (node.children.empty())
+                return copy;
+            copy->children = child_arena->AllocateSpan(node.children.size());
+            for (Int i=0; i<node.children.size(); ++i) {
+                if (node.children[i] != nullptr)
+                    copy->children[i] = CopySubtree(*node.children[i], node_arena, child_arena, action_arena, prior_arena, copies);
+            }
+            return copy;
+        }
+
         double coef_;
         Int num_iters_ = 0;
         Int max_num_iters_ = 0;
+        int64_t time_limit_ = kIntFull;
+        Int check_interval_ = 16;
+        bool early_stop_ = false;
+        bool transposition_ = false;
+        bool widening_ = false;
+        double widening_coef_ = 1.0;
+        double widening_exponent_ = 0.5;
+        std::atomic<bool> stopped_ = false;
+        std::atomic<Int> best_child_ = kIntNull;
+        Timer<> timer_;
+        MCTSStats stats_;
         std::vector<Node*> path_;
         Random rand_;
+        mutable Arena<Node> node_arena_;
+        mutable Arena<Node*> child_arena_{ 1 << 14 };
+        Arena<Int> action_arena_{ 1 << 14 };
+        Arena<float> prior_arena_{ 1 << 14 };
+        Arena<Node> spare_node_arena_;
+        Arena<Node*> spare_child_arena_{ 1 << 14 };
+        Arena<Int> spare_action_arena_{ 1 << 14 };
+        Arena<float> spare_prior_arena_{ 1 << 14 };
+        std::unordered_map<uint64_t, Node*> table_;
+        std::vector<char> child_state_marks_;
     };
 }
@@ -0,0 +1,82 @@
+#pragma once
+#include <chrono>
+#include "rlop/common/typedef.h"
+
+namespace rlop {
+#ifdef RLOP_MCTS_STATS
+    inline constexpr bool kMCTSStats = true;
+#else
+    inline constexpr bool kMCTSStats = false;
+#endif
+
+    // Statistics of an MCTS search. They are collected only when RLOP_MCTS_STATS is defined, in which case the search
+    // reads the clock around each phase of every iteration. Otherwise, the instrumentation compiles away and all the
+    // fields stay zero.
+    struct MCTSStats {
+        Int num_iters = 0;
+        Int num_simulations = 0; // The number of iterations that reached the simulation phase.
+        Int num_nodes = 0; // The number of nodes in the arena at the end of the search.
+        Int max_depth = 0; // The maximum depth of a path, where the root is at depth 0.
+        int64_t select_time = 0; // The time spent in each phase in nanoseconds.
+        int64_t expand_time = 0;
+        int64_t simulate_time = 0;
+        int64_t backpropagate_time = 0;
+        int64_t search_time = 0; // The wall time of the search in nanoseconds.
+        size_t memory = 0; // The number of bytes held by the arenas of the tree.
+
+        // Returns the number of iterations per second.
+        double iters_per_sec() const {
+            return search_time > 0? num_iters * 1e9 / search_time : 0;
+        }
+
+        // Accumulates the statistics of another search, e.g., of another environment. The times are summed, so the
+        // rate of accumulated statistics is per thread.
+        MCTSStats& operator+=(const MCTSStats& other) {
+            num_iters += other.num_iters;
+            num_simulations += other.num_simulations;
+            num_nodes += other.num_nodes;
+            max_depth = std::max(max_depth, other.max_depth);
+            select_time += other.select_time;
+            expand_time += other.expand_time;
+            simulate_time += other.simulate_time;
+            backpropagate_time += other.backpropagate_time;
+            search_time += other.search_time;
+            memory += other.memory;
+            return *this;
+        }
+    };
+
+    // Returns the current time in nanoseconds if the statistics are enabled, or 0 otherwise.
+    inline int64_t StatsClock() {
+        if constexpr (kMCTSStats)
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        else
+            return 0;
+    }
+
+    // Runs a phase of the search and adds its duration to a counter if the statistics are enabled.
+    //
+    // Parameters:
+    //   time: The counter of the phase in nanoseconds.
+    //   func: The phase to run.
+    //
+    // Returns:
+    //   The result of the phase.
+    template<typename TFunc>
+    inline decltype(auto) TimePhase(int64_t* time, TFunc&& func) {
+        if constexpr (!kMCTSStats) {
+            return func();
+        }
+        else if constexpr (std::is_void_v<decltype(func())>) {
+            int64_t start = StatsClock();
+            func();
+            *time += StatsClock() - start;
+        }
+        else {
+            int64_t start = StatsClock();
+            auto result = func();
+            *time += StatsClock() - start;
+            return result;
+        }
+    }
+}
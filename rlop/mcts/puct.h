@@ -1,7 +1,12 @@
 #pragma once
 #include "mcts.h"
+#include "rlop/common/selectors.h"
 
 namespace rlop {
+    // Extends MCTS with the PUCT tree policy, which weights the exploration term of each child by a prior probability.
+    // The priors of a node are queried once when the node is expanded and stored on the node, and the children are
+    // scored in a single pass over a structure of arrays of their statistics and priors. In the progressive widening
+    // mode, the children are added in the descending order of their priors.
     class PUCT : public MCTS {
     public:
         PUCT(double coef = std::sqrt(2)) : MCTS(coef) {} 
@@ -10,6 +15,7 @@ namespace rlop {
 
         // Pure virtual function to return the probability of selecting the child at index `child_i`  
         // according to some policy, typically provided by a neural network or other predictive model.
+        // It is called once per child when the current node is expanded.
         //
         // Parameters:
         //   child_i: The index of the child node for which the selection probability is requested.
@@ -18,11 +24,82 @@ namespace rlop {
         //   double: The probability of selecting the child node at index `child_i`.
         virtual double GetProb(Int child_i) = 0;
 
+        // Allocates the children of the current node together with their priors before expanding a child.
+        virtual bool Expand() override {
+            Node* node = path_.back();
+            if (!widening_ && node->children.empty()) {
+                node->children = child_arena_.AllocateSpan(NumChildStates());
+                node->priors = prior_arena_.AllocateSpan(node->children.size());
+                for (Int i=0; i<node->priors.size(); ++i) {
+                    node->priors[i] = GetProb(i);
+                }
+            }
+            return MCTS::Expand();
+        }
+
         virtual double TreePolicy(Int child_i) override {
             if (path_.back()->children[child_i] == nullptr)
                 return std::numeric_limits<double>::lowest();
             return path_.back()->children[child_i]->mean_reward + 
-                this->coef_ * GetProb(child_i) * std::sqrt((double)path_.back()->children[child_i]->num_visits) / (1.0 + path_.back()->num_visits);
+                this->coef_ * path_.back()->priors[child_i] * std::sqrt((double)path_.back()->children[child_i]->num_visits) / (1.0 + path_.back()->num_visits);
         }
+
+        // Selects the child with the highest PUCT score. The statistics of the children are gathered into contiguous
+        // arrays and scored by ComputePUCTScores(), instead of calling TreePolicy() for each child.
+        virtual std::optional<Int> SelectByTreePolicy() override {
+            const Node& node = *path_.back();
+            Int size = node.children.size();
+            q_values_.resize(size);
+            num_visits_.resize(size);
+            scores_.resize(size);
+            for (Int i=0; i<size; ++i) {
+                const Node* child = node.children[i];
+                q_values_[i] = child == nullptr? std::numeric_limits<double>::lowest() : child->mean_reward;
+                num_visits_[i] = child == nullptr? 0 : child->num_visits;
+            }
+            ComputePUCTScores(q_values_.data(), num_visits_.data(), node.priors.data(), size, coef_ / (1.0 + node.num_visits), scores_.data());
+            return SelectBest(scores_.begin(), scores_.end());
+        }
+
+        // Selects the child state with the highest prior among the ones that have not been added to the current node. The
+        // priors of the current state are queried again, since only the priors of the added children are stored.
+        virtual std::optional<Int> SelectToWiden() override {
+            const Node& node = *path_.back();
+            Int num_child_states = NumChildStates();
+            if (node.num_children >= num_child_states)
+                return std::nullopt;
+            MarkChildStates(node, num_child_states);
+            Int best = kIntNull;
+            double best_prob = std::numeric_limits<double>::lowest();
+            for (Int i=0; i<num_child_states; ++i) {
+                if (child_state_marks_[i])
+                    continue;
+                double prob = GetProb(i);
+                if (prob > best_prob) {
+                    best = i;
+                    best_prob = prob;
+                }
+            }
+            if (best == kIntNull)
+                return std::nullopt;
+            return { best };
+        }
+
+        // Appends a slot for a child state together with its prior.
+        virtual Int AddChildSlot(Node* node, Int child_i, Int num_child_states) override {
+            Int slot = MCTS::AddChildSlot(node, child_i, num_child_states);
+            if (node->priors.size() != node->children.size()) {
+                auto priors = prior_arena_.AllocateSpan(node->children.size());
+                std::copy(node->priors.begin(), node->priors.end(), priors.begin());
+                node->priors = priors;
+            }
+            node->priors[slot] = GetProb(child_i);
+            return slot;
+        }
+
+    protected:
+        std::vector<double> q_values_;
+        std::vector<double> num_visits_;
+        std::vector<double> scores_;
     };
 }
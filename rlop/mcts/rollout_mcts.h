@@ -0,0 +1,76 @@
+#pragma once
+#include "mcts.h"
+
+namespace rlop {
+    // Extends MCTS with a rollout policy resolved at compile time. At each leaf, the state is loaded into the policy
+    // once and a number of light playouts are run from it by calling the non-virtual methods of the policy, so the
+    // simulation loop has neither virtual dispatch nor, for a policy that restores its state by assignment, memory
+    // allocations. The mean reward of the playouts is backpropagated, which lowers the variance of the leaf estimate
+    // for the price of a single traversal of the tree.
+    //
+    // Template Parameters:
+    //   TRollout: The rollout policy. It should be default constructible and provide the following methods:
+    //     - void Restart(): Restores the state loaded at the leaf.
+    //     - bool Step(Random& rand): Advances the state by a move of the default policy. Returns false if the
+    //       playout is over.
+    //     - double Reward() const: Returns the reward of the state, on the same scale as MCTS::Reward().
+    template<typename TRollout>
+    class RolloutMCTS : public MCTS {
+    public:
+        // Constructs a RolloutMCTS with specified parameters.
+        //
+        // Parameters:
+        //   num_playouts: The number of playouts run from each leaf. Default is 1, and at least 1 is run.
+        //   coef: The exploration coefficient used in the UCB1 formula, Default is sqrt(2).
+        RolloutMCTS(Int num_playouts = 1, double coef = std::sqrt(2)) : MCTS(coef), num_playouts_(std::max(Int(1), num_playouts)) {}
+
+        virtual ~RolloutMCTS() = default;
+
+        // Pure virtual function to load the current state, i.e., the leaf reached by the selection and the expansion,
+        // into the rollout policy.
+        //
+        // Parameters:
+        //   rollout: The rollout policy to load the state into.
+        virtual void LoadRollout(TRollout* rollout) = 0;
+
+        // Runs the playouts from the current state and keeps their mean reward for the backpropagation.
+        virtual bool Simulate() override {
+            LoadRollout(&rollout_);
+            double total_reward = 0;
+            for (Int i=0; i<num_playouts_; ++i) {
+                rollout_.Restart();
+                while (rollout_.Step(rand_)) {}
+                total_reward += rollout_.Reward();
+            }
+            rollout_reward_ = total_reward / num_playouts_;
+            return false;
+        }
+
+        using MCTS::BackPropagate;
+
+        // Backpropagates the mean reward of the playouts, or the reward of the current state if the selection or the
+        // expansion ended in a terminal state.
+        virtual void BackPropagate() override {
+            if (rollout_reward_) {
+                BackPropagate(*rollout_reward_);
+                rollout_reward_ = std::nullopt;
+            }
+            else {
+                BackPropagate(Reward());
+            }
+        }
+
+        Int num_playouts() const {
+            return num_playouts_;
+        }
+
+        void set_num_playouts(Int num_playouts) {
+            num_playouts_ = std::max(Int(1), num_playouts);
+        }
+
+    protected:
+        Int num_playouts_;
+        TRollout rollout_;
+        std::optional<double> rollout_reward_;
+    };
+}
@@ -2,18 +2,27 @@
 #include "rlop/common/base_algorithm.h"
 #include "rlop/common/utils.h"
 #include "rlop/common/random.h"
+#include "rlop/common/arena.h"
+#include "rlop/common/timer.h"
+#include "mcts_stats.h"
 
 namespace rlop {
     // Implements a root parallel version of the Monte Carlo Tree Search (MCTS) algorithm. This class
     // allows for simultaneous exploration of multiple start nodes in parallel, making it suitable for
-    // environments where multiple simulations can be run concurrently.
+    // environments where multiple simulations can be run concurrently. Each environment allocates
+    // its tree from its own arenas, so no synchronization is needed between the searches. All the
+    // environments share one clock, so a time limit bounds the search as a whole, and the search can
+    // be interrupted from another thread by Stop(). In the transposition mode, the nodes of each
+    // environment are shared between the move orders that reach the same state.
     class RootParallelMCTS : public BaseAlgorithm {
     public:
         struct Node {
             double mean_reward = 0;
             Int num_visits = 0;
             Int num_children = 0; // The number of children nodes expanded.
-            std::vector<Node*> children;
+            ArenaSpan<Node*> children; // Contiguous child slots in the child arena of the environment.
+            ArenaSpan<float> priors; // Prior probabilities of the children, filled at expansion by RootParallelPUCT.
+            uint64_t key = 0; // The state key in the transposition mode, or 0 if the node is not shared.
         };
         
         // Constructs a RootParallelMCTS instance with specified parameters.
@@ -27,8 +36,21 @@ namespace rlop {
             max_num_iters_(num_envs, 0),
             paths_(num_envs),
             rands_(num_envs),
+            node_arenas_(num_envs),
+            child_arenas_(num_envs),
+            prior_arenas_(num_envs),
+            spare_node_arenas_(num_envs),
+            spare_child_arenas_(num_envs),
+            spare_prior_arenas_(num_envs),
+            tables_(num_envs),
+            stats_(num_envs),
+            best_children_(num_envs),
             coef_(coef) 
-        {}
+        {
+            for (auto& best : best_children_) {
+                best = kIntNull;
+            }
+        }
 
         virtual ~RootParallelMCTS() = default;
 
@@ -63,15 +85,90 @@ namespace rlop {
         // Pure virtual function to return the reward of the current state for a specified environment.
         virtual double Reward(Int env_i) = 0;
 
+        // Returns a key identifying the current state of a specified environment, used to share nodes in the
+        // transposition mode. States reached by different move orders should have the same key, and the states should
+        // not repeat along a path. The default returns 0, which means the state is never shared.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        virtual uint64_t StateKey(Int) {
+            return 0;
+        }
+
         // Resets the algorithm.
         virtual void Reset() override {
             for (Int i=0; i<paths_.size(); ++i) {
-                if (!paths_[i].empty()) {
+                if (!paths_[i].empty())
                     Release(paths_[i][0]);
-                    delete paths_[i][0];
-                }
-                paths_[i] = { NewNode() };
+                node_arenas_[i].Reset();
+                child_arenas_[i].Reset();
+                prior_arenas_[i].Reset();
+                tables_[i].clear();
+                paths_[i] = { NewNode(i) };
+                best_children_[i] = kIntNull;
+            }
+            stopped_ = false;
+            StartClock(kIntFull);
+        }
+
+        // Promotes a child of the root of a specified environment to the new root, keeping the statistics of its
+        // subtree and releasing the sibling subtrees. The state that RevertState() reverts to should be advanced by
+        // the same child. If the child has not been expanded, the tree of the environment is reset instead.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        //   child_i: The index of the child of the root.
+        //
+        // Returns:
+        //   bool: Returns true if the subtree of the child is reused.
+        virtual bool Advance(Int env_i, Int child_i) {
+            const Node* root = paths_[env_i].empty()? nullptr : paths_[env_i].front();
+            if (root == nullptr || child_i < 0 || child_i >= root->children.size())
+                return Reroot(env_i, nullptr);
+            return Reroot(env_i, root->children[child_i]);
+        }
+
+        // Replaces the tree of a specified environment with a copy of the subtree rooted at a node, which may belong to
+        // the tree of any environment. The subtree is compacted into a spare pair of arenas of the environment, which are
+        // then swapped with the current ones. Note that the previous tree of the environment stays readable only until
+        // the environment is rerooted or reset again, so when trees are exchanged between environments, the environment
+        // owning the source nodes should be rerooted last.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        //   node: The root of the subtree to keep. If it is nullptr, the tree of the environment is reset.
+        //
+        // Returns:
+        //   bool: Returns true if a subtree is reused.
+        virtual bool Reroot(Int env_i, const Node* node) {
+            stopped_ = false;
+            if (node == nullptr) {
+                if (!paths_[env_i].empty())
+                    Release(paths_[env_i][0]);
+                node_arenas_[env_i].Reset();
+                child_arenas_[env_i].Reset();
+                prior_arenas_[env_i].Reset();
+                tables_[env_i].clear();
+                paths_[env_i] = { NewNode(env_i) };
+                best_children_[env_i] = kIntNull;
+                return false;
+            }
+            spare_node_arenas_[env_i].Reset();
+            spare_child_arenas_[env_i].Reset();
+            spare_prior_arenas_[env_i].Reset();
+            std::unordered_map<const Node*, Node*> copies;
+            Node* root = CopySubtree(*node, &spare_node_arenas_[env_i], &spare_child_arenas_[env_i], &spare_prior_arenas_[env_i], transposition_? &copies : nullptr);
+            std::swap(node_arenas_[env_i], spare_node_arenas_[env_i]);
+            std::swap(child_arenas_[env_i], spare_child_arenas_[env_i]);
+            std::swap(prior_arenas_[env_i], spare_prior_arenas_[env_i]);
+            tables_[env_i].clear();
+            for (const auto& [source, copy] : copies) {
+                if (copy->key != 0)
+                    tables_[env_i].emplace(copy->key, copy);
             }
+            paths_[env_i] = { root };
+            UpdateBestChild(env_i);
+            return true;
         }
 
         virtual void SetSeeds(const std::vector<uint64_t>& seeds) {
@@ -85,8 +182,31 @@ namespace rlop {
             }
         }
 
+        // Starts the shared clock of the searches with a time limit. It is called by SearchAsync(), and should be called
+        // before running Search() on the environments directly.
+        //
+        // Parameters:
+        //   time_limit: The time limit in milliseconds. kIntFull means no limit.
+        void StartClock(int64_t time_limit) {
+            time_limit_ = time_limit;
+            timer_.Restart();
+        }
+
+        // Interrupts the searches of all the environments at their next iteration. It is safe to call from another
+        // thread. A stop that arrives before the searches start is kept, so they return at once. The flag is cleared by
+        // Reset() and Reroot(), which set up the next search.
+        void Stop() {
+            stopped_.store(true, std::memory_order_relaxed);
+        }
+
         // Starts the asynchronous search across all environments, running each environment's search in parallel.
-        virtual void SearchAsync(Int max_num_iters) {
+        //
+        // Parameters:
+        //   max_num_iters: The maximum number of iterations of each environment.
+        //   time_limit: The time limit in milliseconds shared by all the environments. Default is kIntFull, i.e., no
+        //               limit.
+        virtual void SearchAsync(Int max_num_iters, int64_t time_limit = kIntFull) {
+            StartClock(time_limit);
             #pragma omp parallel for
             for (Int i=0; i<num_envs(); ++i) {
                 Search(i, max_num_iters);
@@ -101,18 +221,95 @@ namespace rlop {
         virtual void Search(Int env_i, Int max_num_iters) {
             num_iters_[env_i] = 0;
             max_num_iters_[env_i] = max_num_iters;
+            MCTSStats& stats = stats_[env_i];
+            stats = MCTSStats();
+            int64_t start = StatsClock();
             while (Proceed(env_i)) {
                 RevertState(env_i);
-                if (Select(env_i) && Expand(env_i))
-                    Simulate(env_i);
-                BackPropagate(env_i);
+                if (TimePhase(&stats.select_time, [&] { return Select(env_i); }) && TimePhase(&stats.expand_time, [&] { return Expand(env_i); })) {
+                    TimePhase(&stats.simulate_time, [&] { return Simulate(env_i); });
+                    if constexpr (kMCTSStats)
+                        ++stats.num_simulations;
+                }
+                if constexpr (kMCTSStats)
+                    stats.max_depth = std::max(stats.max_depth, Int(paths_[env_i].size()) - 1);
+                TimePhase(&stats.backpropagate_time, [&] { BackPropagate(env_i); });
                 Update(env_i);
             }
+            UpdateBestChild(env_i);
+            if constexpr (kMCTSStats) {
+                stats.search_time = StatsClock() - start;
+                stats.num_iters = num_iters_[env_i];
+                stats.num_nodes = node_arenas_[env_i].size();
+                stats.memory = node_arenas_[env_i].capacity() * sizeof(Node) + child_arenas_[env_i].capacity() * sizeof(Node*) + 
+                    prior_arenas_[env_i].capacity() * sizeof(float);
+            }
         }
 
-        // Checks if the search of a specified environment should continue.
+        // Checks if the search of a specified environment should continue. Besides the iteration budget and the stop
+        // flag, which are checked every iteration, the time limit and the early stopping rule are checked every
+        // check_interval() iterations.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
         virtual bool Proceed(Int env_i) {
-            return num_iters_[env_i] < max_num_iters_[env_i]; 
+            if (num_iters_[env_i] >= max_num_iters_[env_i] || stopped_.load(std::memory_order_relaxed))
+                return false;
+            if (num_iters_[env_i] % check_interval_ != 0)
+                return true;
+            UpdateBestChild(env_i);
+            if (time_limit_ != kIntFull && timer_.Elapsed() >= time_limit_)
+                return false;
+            return !(early_stop_ && IsDecided(env_i));
+        }
+
+        // Checks whether the most visited child of the root of a specified environment can no longer be overtaken
+        // within the remaining budget of the environment. Under a time limit, the remaining iterations are estimated
+        // from the rate of the search so far.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        //
+        // Returns:
+        //   bool: Returns true if the remaining budget cannot change the most visited child of the root.
+        virtual bool IsDecided(Int env_i) const {
+            if (paths_[env_i].empty())
+                return false;
+            Int first = 0;
+            Int second = 0;
+            for (const Node* child : paths_[env_i].front()->children) {
+                Int num_visits = child == nullptr ? 0 : child->num_visits;
+                if (num_visits > first) {
+                    second = first;
+                    first = num_visits;
+                }
+                else if (num_visits > second) {
+                    second = num_visits;
+                }
+            }
+            Int num_remaining_iters = max_num_iters_[env_i] - num_iters_[env_i];
+            if (time_limit_ != kIntFull) {
+                int64_t elapsed = timer_.Elapsed();
+                if (elapsed <= 0)
+                    return false;
+                num_remaining_iters = std::min(num_remaining_iters, Int(num_iters_[env_i] * std::max(int64_t(0), time_limit_ - elapsed) / elapsed));
+            }
+            return first - second > num_remaining_iters;
+        }
+
+        // Returns the most visited child of the root of a specified environment as of the last check of its search. It
+        // is safe to call from another thread while the search runs.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        //
+        // Returns:
+        //   std::optional<Int>: The index of the child, or std::nullopt if the root has no visited children.
+        std::optional<Int> BestChild(Int env_i) const {
+            Int best = best_children_[env_i].load(std::memory_order_relaxed);
+            if (best == kIntNull)
+                return std::nullopt;
+            return { best };
         }
 
         // Selects the next node to explore in the tree based on the tree policy for a specified environment.
@@ -139,18 +336,20 @@ namespace rlop {
         //   env_i: The index of environment.
         virtual bool Expand(Int env_i) {
             if (paths_[env_i].back()->children.empty())
-                paths_[env_i].back()->children = std::vector<Node*>(NumChildStates(env_i));
+                paths_[env_i].back()->children = child_arenas_[env_i].AllocateSpan(NumChildStates(env_i));
             if (paths_[env_i].back()->children.empty())
                 return false;
             auto child_i = SelectToExpand(env_i);
             if (!child_i)
                 return false;
-            if (paths_[env_i].back()->children[*child_i] == nullptr) {
-                paths_[env_i].back()->children[*child_i] = NewNode();
-                ++paths_[env_i].back()->num_children;
+            Node* node = paths_[env_i].back();
+            bool stepped = Step(env_i, *child_i);
+            if (node->children[*child_i] == nullptr) {
+                node->children[*child_i] = transposition_? FindOrNewNode(env_i) : NewNode(env_i);
+                ++node->num_children;
             }
-            paths_[env_i].push_back(paths_[env_i].back()->children[*child_i]);
-            return Step(env_i, *child_i);
+            paths_[env_i].push_back(node->children[*child_i]);
+            return stepped;
         }
 
         // Simulates the outcome from the current state to the end of the episode for a specified environment.
@@ -170,7 +369,15 @@ namespace rlop {
         // Parameters:
         //   env_i: The index of environment.
         virtual void BackPropagate(Int env_i) {
-            double reward = Reward(env_i);
+            BackPropagate(env_i, Reward(env_i));
+        }
+
+        // Backpropagates a reward through the path in the tree for a specified environment.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        //   reward: The reward of the simulation.
+        virtual void BackPropagate(Int env_i, double reward) {
             while (paths_[env_i].size() > 1) {
                 UpdateNode(env_i, reward);
                 paths_[env_i].pop_back();
@@ -182,19 +389,45 @@ namespace rlop {
             ++num_iters_[env_i];
         }
 
+        // Detaches the subtree of a node. The memory is reclaimed in bulk when the arenas of the environment owning
+        // the node are reset.
+        //
+        // Parameters:
+        //   node: The root of the subtree.
         virtual void Release(Node* node) {
             if (node == nullptr) 
                 return;
-            for (Int i=0; i<node->children.size(); ++i) {
-                Node* child = node->children[i];
-                Release(child);
-                delete child;
-            }
             node->children.clear();
+            node->num_children = 0;
         }
 
-        virtual Node* NewNode() const {
-            return new Node();
+        // Allocates a new node from the arena of a specified environment.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        virtual Node* NewNode(Int env_i) {
+            return node_arenas_[env_i].Allocate();
+        }
+
+        // Returns the node shared by the current state of a specified environment in the transposition mode, allocating
+        // and registering a new node if the state has not been reached before. A node already on the current path is
+        // never returned, so a step that leaves the state unchanged does not create a cycle.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        virtual Node* FindOrNewNode(Int env_i) {
+            uint64_t key = StateKey(env_i);
+            if (key == 0)
+                return NewNode(env_i);
+            auto [it, inserted] = tables_[env_i].try_emplace(key, nullptr);
+            if (!inserted && std::find(paths_[env_i].begin(), paths_[env_i].end(), it->second) == paths_[env_i].end())
+                return it->second;
+            Node* node = NewNode(env_i);
+            if (inserted) {
+                node->key = key;
+                it->second = node;
+            }
+            return node;
         }
 
         virtual void UpdateNode(Int env_i, double reward) const {
@@ -253,7 +486,7 @@ namespace rlop {
         virtual std::optional<Int> SelectToExpand(Int env_i) {
             if (paths_[env_i].back()->children.empty())
                 return std::nullopt;
-            return { rands_[env_i].Uniform(size_t(0), paths_[env_i].back()->children.size()-1) };
+            return { rands_[env_i].UniformIndex(Int(paths_[env_i].back()->children.size())) };
         }
 
         // Selects a child state randomly from the current state for a specified environment. This method is used during the 
@@ -269,7 +502,7 @@ namespace rlop {
             Int num_children = NumChildStates(env_i);
             if (num_children <= 0)
                 return std::nullopt;
-            return { rands_[env_i].Uniform(Int(0), num_children - 1) };
+            return { rands_[env_i].UniformIndex(num_children) };
         }
 
         const Int num_envs() const {
@@ -280,19 +513,125 @@ namespace rlop {
             return paths_;
         }
 
+        // Returns the number of nodes allocated for a specified environment since the last reset.
+        Int num_nodes(Int env_i) const {
+            return node_arenas_[env_i].size();
+        }
+
+        bool transposition() const {
+            return transposition_;
+        }
+
+        // Returns the statistics of the last search of a specified environment, which are collected only when
+        // RLOP_MCTS_STATS is defined. The statistics of all the environments can be accumulated by MCTSStats::operator+=.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        const MCTSStats& stats(Int env_i) const {
+            return stats_[env_i];
+        }
+
         double coef() const {
             return coef_;
         }
 
+        Int num_iters(Int env_i) const {
+            return num_iters_[env_i];
+        }
+
+        Int check_interval() const {
+            return check_interval_;
+        }
+
+        bool early_stop() const {
+            return early_stop_;
+        }
+
         void set_coef(double coef) {
             coef_ = coef;
         }
 
+        // Enables the transposition mode, in which the nodes of each environment are shared by the states with the same
+        // StateKey(). It should be set before the trees are built.
+        void set_transposition(bool transposition) {
+            transposition_ = transposition;
+        }
+
+        void set_check_interval(Int check_interval) {
+            check_interval_ = std::max(Int(1), check_interval);
+        }
+
+        // Enables stopping the search of an environment once the most visited child of its root is decided. See
+        // IsDecided().
+        void set_early_stop(bool early_stop) {
+            early_stop_ = early_stop;
+        }
+
     protected:
+        // Publishes the most visited child of the root of a specified environment for BestChild().
+        void UpdateBestChild(Int env_i) {
+            Int best = kIntNull;
+            Int best_num_visits = 0;
+            if (!paths_[env_i].empty()) {
+                const auto& children = paths_[env_i].front()->children;
+                for (Int i=0; i<children.size(); ++i) {
+                    if (children[i] != nullptr && children[i]->num_visits > best_num_visits) {
+                        best = i;
+                        best_num_visits = children[i]->num_visits;
+                    }
+                }
+            }
+            best_children_[env_i].store(best, std::memory_order_relaxed);
+        }
+
+        // Copies the subtree rooted at a node into the given arenas. When a map of the copied nodes is given, shared nodes
+        // are copied once and the map is filled with the copy of each node.
+        //
+        // Returns:
+        //   Node*: The copy of the node.
+        Node* CopySubtree(const Node& node, Arena<Node>* node_arena, Arena<Node*>* child_arena, Arena<float>* prior_arena, std::unordered_map<const Node*, Node*>* copies) const {
+            if (copies != nullptr) {
+                auto it = copies->find(&node);
+                if (it != copies->end())
+                    return it->second;
+            }
+            Node* copy = node_arena->Allocate();
+            *copy = node;
+            if (copies != nullptr)
+                copies->emplace(&node, copy);
+            if (!node.priors.empty()) {
+                copy->priors = prior_arena->AllocateSpan(node.priors.size());
+                std::copy(node.priors.begin(), node.priors.end(), copy->priors.begin());
+            }
+            if (node.children.empty())
+                return copy;
+            copy->children = child_arena->AllocateSpan(node.children.size());
+            for (Int i=0; i<node.children.size(); ++i) {
+                if (node.children[i] != nullptr)
+                    copy->children[i] = CopySubtree(*node.children[i], node_arena, child_arena, prior_arena, copies);
+            }
+            return copy;
+        }
+
         double coef_;
         std::vector<Int> num_iters_;
         std::vector<Int> max_num_iters_;
         std::vector<std::vector<Node*>> paths_;
         std::vector<Random> rands_;
+        std::vector<Arena<Node>> node_arenas_;
+        mutable std::vector<Arena<Node*>> child_arenas_;
+        std::vector<Arena<float>> prior_arenas_;
+        std::vector<Arena<Node>> spare_node_arenas_;
+        std::vector<Arena<Node*>> spare_child_arenas_;
+        std::vector<Arena<float>> spare_prior_arenas_;
+        std::vector<std::unordered_map<uint64_t, Node*>> tables_;
+        std::vector<MCTSStats> stats_;
+        std::vector<std::atomic<Int>> best_children_;
+        int64_t time_limit_ = kIntFull;
+        Int check_interval_ = 16;
+        bool early_stop_ = false;
+        bool transposition_ = false;
+        std::atomic<bool> stopped_ = false;
+        Timer<> timer_;
     };
 }
@@ -1,15 +1,20 @@
 #pragma once
 #include "root_parallel_mcts.h"
+#include "rlop/common/selectors.h"
 
 namespace rlop {
+    // Extends RootParallelMCTS with the PUCT tree policy. The priors of a node are queried once when the node is
+    // expanded and stored on the node, and the children are scored in a single pass over a structure of arrays of
+    // their statistics and priors.
     class RootParallelPUCT : public RootParallelMCTS {
     public:
-        RootParallelPUCT(Int num_envs, double coef = std::sqrt(2)) : RootParallelMCTS(num_envs, coef) {} 
+        RootParallelPUCT(Int num_envs, double coef = std::sqrt(2)) : RootParallelMCTS(num_envs, coef), buffers_(num_envs) {} 
 
         virtual ~RootParallelPUCT() = default;
 
         // Pure virtual function to return the probability of selecting the child at index `child_i` 
         // according to some policy, typically provided by a neural network or other predictive model.
+        // It is called once per child when the current node is expanded.
         //
         // Parameters:
         //   env_i: The index of environment.
@@ -19,11 +24,58 @@ namespace rlop {
         //   double: The probability of selecting the child node at index `child_i`.
         virtual double GetProb(Int env_i, Int child_i) = 0;
 
+        // Allocates the children of the current node together with their priors before expanding a child for a
+        // specified environment.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        virtual bool Expand(Int env_i) override {
+            Node* node = paths_[env_i].back();
+            if (node->children.empty()) {
+                node->children = child_arenas_[env_i].AllocateSpan(NumChildStates(env_i));
+                node->priors = prior_arenas_[env_i].AllocateSpan(node->children.size());
+                for (Int i=0; i<node->priors.size(); ++i) {
+                    node->priors[i] = GetProb(env_i, i);
+                }
+            }
+            return RootParallelMCTS::Expand(env_i);
+        }
+
         virtual double TreePolicy(Int env_i, Int child_i) override {
             if (paths_[env_i].back()->children[child_i] == nullptr)
                 return std::numeric_limits<double>::lowest();
             return paths_[env_i].back()->children[child_i]->mean_reward + 
-                coef_ * GetProb(env_i, child_i) * std::sqrt((double)paths_[env_i].back()->children[child_i]->num_visits) / (1.0 + paths_[env_i].back()->num_visits);
+                coef_ * paths_[env_i].back()->priors[child_i] * std::sqrt((double)paths_[env_i].back()->children[child_i]->num_visits) / (1.0 + paths_[env_i].back()->num_visits);
+        }
+
+        // Selects the child with the highest PUCT score for a specified environment. The statistics of the children are
+        // gathered into contiguous arrays and scored by ComputePUCTScores(), instead of calling TreePolicy() for each child.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        virtual std::optional<Int> SelectTreePolicy(Int env_i) override {
+            const Node& node = *paths_[env_i].back();
+            Int size = node.children.size();
+            auto& buffer = buffers_[env_i];
+            buffer.q_values.resize(size);
+            buffer.num_visits.resize(size);
+            buffer.scores.resize(size);
+            for (Int i=0; i<size; ++i) {
+                const Node* child = node.children[i];
+                buffer.q_values[i] = child == nullptr? std::numeric_limits<double>::lowest() : child->mean_reward;
+                buffer.num_visits[i] = child == nullptr? 0 : child->num_visits;
+            }
+            ComputePUCTScores(buffer.q_values.data(), buffer.num_visits.data(), node.priors.data(), size, coef_ / (1.0 + node.num_visits), buffer.scores.data());
+            return SelectBest(buffer.scores.begin(), buffer.scores.end());
         }
+
+    protected:
+        struct ScoreBuffer {
+            std::vector<double> q_values;
+            std::vector<double> num_visits;
+            std::vector<double> scores;
+        };
+
+        std::vector<ScoreBuffer> buffers_;
     };
 }
@@ -0,0 +1,85 @@
+#pragma once
+#include "root_parallel_mcts.h"
+
+namespace rlop {
+    // Extends RootParallelMCTS with a rollout policy resolved at compile time. Each environment owns a copy of the
+    // policy, into which the state of its leaf is loaded once before a number of light playouts are run by calling the
+    // non-virtual methods of the policy. See RolloutMCTS for the requirements of the policy.
+    //
+    // Template Parameters:
+    //   TRollout: The rollout policy.
+    template<typename TRollout>
+    class RootParallelRolloutMCTS : public RootParallelMCTS {
+    public:
+        // Constructs a RootParallelRolloutMCTS with specified parameters.
+        //
+        // Parameters:
+        //   num_envs: The number of environments to run in parallel.
+        //   num_playouts: The number of playouts run from each leaf. Default is 1, and at least 1 is run.
+        //   coef: The exploration coefficient used in the UCB1 formula, Default is sqrt(2).
+        RootParallelRolloutMCTS(Int num_envs, Int num_playouts = 1, double coef = std::sqrt(2)) :
+            RootParallelMCTS(num_envs, coef),
+            num_playouts_(std::max(Int(1), num_playouts)),
+            rollouts_(num_envs),
+            rollout_rewards_(num_envs)
+        {}
+
+        virtual ~RootParallelRolloutMCTS() = default;
+
+        // Pure virtual function to load the current state of a specified environment, i.e., the leaf reached by the
+        // selection and the expansion, into the rollout policy.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        //   rollout: The rollout policy to load the state into.
+        virtual void LoadRollout(Int env_i, TRollout* rollout) = 0;
+
+        // Runs the playouts from the current state of a specified environment and keeps their mean reward for the
+        // backpropagation.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        virtual bool Simulate(Int env_i) override {
+            TRollout& rollout = rollouts_[env_i];
+            LoadRollout(env_i, &rollout);
+            double total_reward = 0;
+            for (Int i=0; i<num_playouts_; ++i) {
+                rollout.Restart();
+                while (rollout.Step(rands_[env_i])) {}
+                total_reward += rollout.Reward();
+            }
+            rollout_rewards_[env_i] = total_reward / num_playouts_;
+            return false;
+        }
+
+        using RootParallelMCTS::BackPropagate;
+
+        // Backpropagates the mean reward of the playouts of a specified environment, or the reward of its current state
+        // if the selection or the expansion ended in a terminal state.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        virtual void BackPropagate(Int env_i) override {
+            if (rollout_rewards_[env_i]) {
+                BackPropagate(env_i, *rollout_rewards_[env_i]);
+                rollout_rewards_[env_i] = std::nullopt;
+            }
+            else {
+                BackPropagate(env_i, Reward(env_i));
+            }
+        }
+
+        Int num_playouts() const {
+            return num_playouts_;
+        }
+
+        void set_num_playouts(Int num_playouts) {
+            num_playouts_ = std::max(Int(1), num_playouts);
+        }
+
+    protected:
+        Int num_playouts_;
+        std::vector<TRollout> rollouts_;
+        std::vector<std::optional<double>> rollout_rewards_;
+    };
+}
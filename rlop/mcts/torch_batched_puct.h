@@ -0,0 +1,63 @@
+#pragma once
+#include "batched_puct.h"
+#include "rlop/common/torch_utils.h"
+
+namespace rlop {
+    // Extends BatchedPUCT with a libtorch model, which evaluates the stacked observations of the pending leaves in a
+    // single forward pass.
+    class TorchBatchedPUCT : public BatchedPUCT {
+    public:
+        TorchBatchedPUCT(Int batch_size = 32, int64_t timeout = 1000, double coef = 1.25, double virtual_loss = 1.0) :
+            BatchedPUCT(batch_size, timeout, coef, virtual_loss)
+        {}
+
+        virtual ~TorchBatchedPUCT() = default;
+
+        // Pure virtual function to return the observation of the current state, without the batch dimension.
+        virtual torch::Tensor Observe() = 0;
+
+        // Pure virtual function to evaluate a batch of observations with the model.
+        //
+        // Parameters:
+        //   observations: The stacked observations of the pending leaves.
+        //
+        // Returns:
+        //   std::array<torch::Tensor, 2>: An array containing:
+        //     - [0]: The prior probabilities of shape [batch_size, num_actions]. The first NumChildStates() entries of
+        //            each row are used for the children of the corresponding leaf.
+        //     - [1]: The values of shape [batch_size] or [batch_size, 1], on the same scale as Reward().
+        virtual std::array<torch::Tensor, 2> Predict(const torch::Tensor& observations) = 0;
+
+        virtual void Reset() override {
+            BatchedPUCT::Reset();
+            observations_.clear();
+        }
+
+        virtual void ObserveLeaf(Int leaf_i) override {
+            observations_.resize(leaf_i + 1);
+            observations_[leaf_i] = Observe();
+        }
+
+        // Stacks the observations, runs the model without gradients and copies the outputs to the buffers of the
+        // search. Throws std::runtime_error if the outputs do not have a row for each leaf.
+        virtual void PredictLeaves(Int num_leaves, std::vector<float>* priors, std::vector<float>* values) override {
+            torch::Tensor prior_tensor, value_tensor;
+            {
+                torch::NoGradGuard no_grad;
+                auto outputs = Predict(torch::stack(std::vector<torch::Tensor>(observations_.begin(), observations_.begin() + num_leaves)));
+                prior_tensor = outputs[0].to(torch::kCPU, torch::kFloat).contiguous();
+                value_tensor = outputs[1].to(torch::kCPU, torch::kFloat).contiguous().view({ -1 });
+            }
+            observations_.clear();
+            if (prior_tensor.dim() != 2 || prior_tensor.size(0) != num_leaves || value_tensor.size(0) != num_leaves)
+                throw std::runtime_error("TorchBatchedPUCT: expected priors of shape [" + std::to_string(num_leaves) + ", num_actions] and " + std::to_string(num_leaves) + " values.");
+            const float* prior_data = prior_tensor.data_ptr<float>();
+            const float* value_data = value_tensor.data_ptr<float>();
+            priors->assign(prior_data, prior_data + prior_tensor.numel());
+            values->assign(value_data, value_data + value_tensor.numel());
+        }
+
+    protected:
+        std::vector<torch::Tensor> observations_;
+    };
+}
@@ -0,0 +1,383 @@
+#pragma once
+#include <atomic>
+#include "rlop/common/base_algorithm.h"
+#include "rlop/common/utils.h"
+#include "rlop/common/random.h"
+#include "rlop/common/arena.h"
+
+namespace rlop {
+    // Implements a tree parallel version of the Monte Carlo Tree Search (MCTS) algorithm, in which multiple
+    // threads search one shared tree. Node statistics are updated atomically, virtual losses are applied to
+    // the nodes on the path being searched to steer concurrent threads towards different branches, and
+    // children are expanded lock-free by compare-and-swap. Each thread works on its own environment, whose
+    // index is passed to the interface functions, and allocates nodes from its own arenas.
+    class TreeParallelMCTS : public BaseAlgorithm {
+    public:
+        struct Node {
+            std::atomic<double> total_reward{ 0 };
+            std::atomic<Int> num_visits{ 0 };
+            std::atomic<Int> num_virtual_losses{ 0 }; // The number of threads currently searching through the node.
+            std::atomic<Int> num_children{ 0 }; // The number of children nodes expanded.
+            std::atomic<Int> num_child_slots{ 0 };
+            std::atomic<std::atomic<Node*>*> children{ nullptr }; // Published once with num_child_slots slots.
+        };
+
+        // Constructs a TreeParallelMCTS instance with specified parameters.
+        //
+        // Parameters:
+        //   num_envs: The number of environments, i.e. the number of threads searching the shared tree.
+        //   coef: The exploration coefficient used in the UCB1 formula, Default is sqrt(2).
+        //   virtual_loss: The reward deducted for each thread passing through a node, Default is 1.
+        TreeParallelMCTS(Int num_envs, double coef = std::sqrt(2), double virtual_loss = 1.0) :
+            coef_(coef),
+            virtual_loss_(virtual_loss),
+            paths_(num_envs),
+            rands_(num_envs),
+            node_arenas_(num_envs),
+            child_arenas_(num_envs)
+        {}
+
+        virtual ~TreeParallelMCTS() = default;
+
+        // Pure virtual function to return the total number of child states from the current state for a specified environment.
+        virtual Int NumChildStates(Int env_i) const = 0;
+
+        // Pure virtual function to determine whether a node has been fully expanded for a specified environment.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        //
+        // Return:
+        //   bool: Returns true if the node is fully expanded.
+        virtual bool IsExpanded(Int env_i, const Node& node) const = 0;
+
+        // Pure virtual function to revert the state of a specified environment to the root state of the search.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        virtual void RevertState(Int env_i) = 0;
+
+        // Pure virtual function to advance a specified environment state based on the selected child index.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        //   child_i: The index of the child to move to.
+        //
+        // Return:
+        //   bool: Returns true if the step was successful. Returns false if the step was unsuccessful.
+        virtual bool Step(Int env_i, Int child_i) = 0;
+
+        // Pure virtual function to return the reward of the current state for a specified environment.
+        virtual double Reward(Int env_i) = 0;
+
+        // Resets the algorithm.
+        virtual void Reset() override {
+            for (Int i=0; i<num_envs(); ++i) {
+                node_arenas_[i].Reset();
+                child_arenas_[i].Reset();
+                paths_[i].clear();
+            }
+            root_ = NewNode(0);
+        }
+
+        virtual void SetSeeds(const std::vector<uint64_t>& seeds) {
+            if (seeds.empty())
+                return;
+            for (Int i=0; i<rands_.size(); ++i) {
+                if (i < seeds.size())
+                    rands_[i].Seed(seeds[i]);
+                else
+                    rands_[i].Seed(seeds.back());
+            }
+        }
+
+        // Searches the shared tree with one thread per environment until the total number of iterations
+        // across all threads reaches the maximum.
+        //
+        // Parameters:
+        //   max_num_iters: The maximum number of iterations shared by all threads.
+        virtual void SearchAsync(Int max_num_iters) {
+            num_iters_ = 0;
+            max_num_iters_ = max_num_iters;
+            #pragma omp parallel for num_threads(num_envs())
+            for (Int i=0; i<num_envs(); ++i) {
+                Search(i);
+            }
+        }
+
+        // Runs search iterations on the shared tree for a specified environment until the shared iteration
+        // budget is used up.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        virtual void Search(Int env_i) {
+            while (Proceed(env_i)) {
+                RevertState(env_i);
+                if (Select(env_i) && Expand(env_i))
+                    Simulate(env_i);
+                BackPropagate(env_i);
+                Update(env_i);
+            }
+        }
+
+        // Checks if the search should continue. The budget is claimed before the iteration starts, so the total
+        // number of iterations never exceeds the maximum.
+        virtual bool Proceed(Int) {
+            return num_iters_.fetch_add(1, std::memory_order_relaxed) < max_num_iters_;
+        }
+
+        // Selects the next node to explore in the shared tree based on the tree policy for a specified environment,
+        // applying a virtual loss to every node on the path.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        virtual bool Select(Int env_i) {
+            paths_[env_i].clear();
+            Push(env_i, root_);
+            while (IsExpanded(env_i, *paths_[env_i].back())) {
+                auto child_i = SelectTreePolicy(env_i);
+                if (!child_i)
+                    return false;
+                Push(env_i, GetChild(*paths_[env_i].back(), *child_i));
+                if (!Step(env_i, *child_i))
+                    return false;
+            }
+            return true;
+        }
+
+        // Expands the current node by adding a new child node to the shared tree for a specified environment. If
+        // another thread expands the same child concurrently, the node it published is used.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        virtual bool Expand(Int env_i) {
+            Node* node = paths_[env_i].back();
+            if (!AllocateChildren(env_i, node))
+                return false;
+            auto child_i = SelectToExpand(env_i);
+            if (!child_i)
+                return false;
+            std::atomic<Node*>& slot = node->children.load(std::memory_order_acquire)[*child_i];
+            Node* child = slot.load(std::memory_order_acquire);
+            if (child == nullptr) {
+                Node* new_child = NewNode(env_i);
+                if (slot.compare_exchange_strong(child, new_child, std::memory_order_acq_rel)) {
+                    child = new_child;
+                    node->num_children.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            Push(env_i, child);
+            return Step(env_i, *child_i);
+        }
+
+        // Simulates the outcome from the current state to the end of the episode for a specified environment.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        virtual bool Simulate(Int env_i) {
+            while (true) {
+                auto i = SelectRandom(env_i);
+                if (!i || !Step(env_i, *i))
+                    return false;
+            }
+        }
+
+        // Backpropagates the simulation results through the path in the shared tree for a specified environment,
+        // reverting the virtual losses applied during selection.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        virtual void BackPropagate(Int env_i) {
+            double reward = Reward(env_i);
+            while (paths_[env_i].size() > 1) {
+                UpdateNode(env_i, reward);
+                paths_[env_i].pop_back();
+            }
+            UpdateNode(env_i, reward);
+        }
+
+        virtual void Update(Int) {}
+
+        virtual Node* NewNode(Int env_i) const {
+            return node_arenas_[env_i].Allocate();
+        }
+
+        virtual void UpdateNode(Int env_i, double reward) const {
+            Node* node = paths_[env_i].back();
+            double total = node->total_reward.load(std::memory_order_relaxed);
+            while (!node->total_reward.compare_exchange_weak(total, total + reward, std::memory_order_relaxed));
+            node->num_visits.fetch_add(1, std::memory_order_relaxed);
+            node->num_virtual_losses.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        // Computes the value of a child node using the UCB1 formula for a specified environment. The statistics
+        // include the virtual losses of the threads currently searching through the child.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        //   child_i: The index of the child node.
+        //
+        // Return:
+        //   double: the value of the child node.
+        virtual double TreePolicy(Int env_i, Int child_i) {
+            const Node* node = paths_[env_i].back();
+            const Node* child = GetChild(*node, child_i);
+            if (child == nullptr)
+                return std::numeric_limits<double>::lowest();
+            Int num_losses = child->num_virtual_losses.load(std::memory_order_relaxed);
+            Int num_visits = child->num_visits.load(std::memory_order_relaxed) + num_losses;
+            if (num_visits == 0)
+                return std::numeric_limits<double>::max();
+            double mean_reward = (child->total_reward.load(std::memory_order_relaxed) - num_losses * virtual_loss_) / num_visits;
+            Int total_num_visits = node->num_visits.load(std::memory_order_relaxed) + node->num_virtual_losses.load(std::memory_order_relaxed);
+            return UCB1(mean_reward, num_visits, total_num_visits, coef_);
+        }
+
+        // Selects the next child node to explore based on the tree policy for a specified environment.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        //
+        // Returns:
+        //   std::optional<Int>: The index of the child node with the highest UCB1 score. If the current node has no legal
+        //                       children, returns std::nullopt.
+        virtual std::optional<Int> SelectTreePolicy(Int env_i) {
+            Int best = kIntNull;
+            double best_score = std::numeric_limits<double>::lowest();
+            for (Int i=0; i<NumChildSlots(*paths_[env_i].back()); ++i) {
+                double score = TreePolicy(env_i, i);
+                if (score > best_score) {
+                    best = i;
+                    best_score = score;
+                }
+            }
+            if (best == kIntNull)
+                return std::nullopt;
+            return { best };
+        }
+
+        // Selects a child node to expand next from the current node's children for a specified environment.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        //
+        // Returns:
+        //   std::optional<Int>: The index of the child node selected for expansion. If the current node has no legal children,
+        //                       returns std::nullopt.
+        virtual std::optional<Int> SelectToExpand(Int env_i) {
+            Int num_slots = NumChildSlots(*paths_[env_i].back());
+            if (num_slots <= 0)
+                return std::nullopt;
+            return { rands_[env_i].UniformIndex(num_slots) };
+        }
+
+        // Selects a child state randomly from the current state for a specified environment. This method is used during the
+        // simulation phase.
+        //
+        // Parameters:
+        //   env_i: The index of environment.
+        //
+        // Returns:
+        //   std::optional<Int>: The index of the randomly selected child node. If there is no legal child state available from
+        //                       the current state, returns std::nullopt.
+        virtual std::optional<Int> SelectRandom(Int env_i) {
+            Int num_children = NumChildStates(env_i);
+            if (num_children <= 0)
+                return std::nullopt;
+            return { rands_[env_i].UniformIndex(num_children) };
+        }
+
+        // Returns the number of child slots of a node, or 0 if the node has not been expanded yet.
+        static Int NumChildSlots(const Node& node) {
+            if (node.children.load(std::memory_order_acquire) == nullptr)
+                return 0;
+            return node.num_child_slots.load(std::memory_order_relaxed);
+        }
+
+        // Returns the child of a node at a specified index, or nullptr if the child has not been expanded yet.
+        static Node* GetChild(const Node& node, Int child_i) {
+            std::atomic<Node*>* children = node.children.load(std::memory_order_acquire);
+            if (children == nullptr)
+                return nullptr;
+            return children[child_i].load(std::memory_order_acquire);
+        }
+
+        static double MeanReward(const Node& node) {
+            Int num_visits = node.num_visits.load(std::memory_order_relaxed);
+            if (num_visits == 0)
+                return 0;
+            return node.total_reward.load(std::memory_order_relaxed) / num_visits;
+        }
+
+        const Int num_envs() const {
+            return paths_.size();
+        }
+
+        const Node* root() const {
+            return root_;
+        }
+
+        const std::vector<std::vector<Node*>>& paths() const {
+            return paths_;
+        }
+
+        // Returns the number of nodes allocated by all environments since the last reset.
+        Int num_nodes() const {
+            Int num_nodes = 0;
+            for (const auto& arena : node_arenas_) {
+                num_nodes += arena.size();
+            }
+            return num_nodes;
+        }
+
+        double coef() const {
+            return coef_;
+        }
+
+        double virtual_loss() const {
+            return virtual_loss_;
+        }
+
+        void set_coef(double coef) {
+            coef_ = coef;
+        }
+
+        void set_virtual_loss(double virtual_loss) {
+            virtual_loss_ = virtual_loss;
+        }
+
+    protected:
+        // Appends a node to the path of a specified environment and applies a virtual loss to it.
+        void Push(Int env_i, Node* node) {
+            node->num_virtual_losses.fetch_add(1, std::memory_order_relaxed);
+            paths_[env_i].push_back(node);
+        }
+
+        // Publishes the child slots of a node if no thread has done it yet.
+        //
+        // Returns:
+        //   bool: Returns false if the node has no children.
+        bool AllocateChildren(Int env_i, Node* node) {
+            if (node->children.load(std::memory_order_acquire) != nullptr)
+                return node->num_child_slots.load(std::memory_order_relaxed) > 0;
+            Int num_slots = NumChildStates(env_i);
+            if (num_slots <= 0)
+                return false;
+            std::atomic<Node*>* slots = child_arenas_[env_i].Allocate(num_slots);
+            std::atomic<Node*>* expected = nullptr;
+            node->num_child_slots.store(num_slots, std::memory_order_relaxed);
+            node->children.compare_exchange_strong(expected, slots, std::memory_order_acq_rel);
+            return true;
+        }
+
+        double coef_;
+        double virtual_loss_;
+        std::atomic<Int> num_iters_{ 0 };
+        Int max_num_iters_ = 0;
+        Node* root_ = nullptr;
+        std::vector<std::vector<Node*>> paths_;
+        std::vector<Random> rands_;
+        mutable std::vector<Arena<Node>> node_arenas_;
+        mutable std::vector<Arena<std::atomic<Node*>>> child_arenas_;
+    };
+}
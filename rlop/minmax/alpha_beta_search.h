@@ -1,11 +1,19 @@
 #pragma once
 #include "rlop/common/base_algorithm.h"
+#include "rlop/common/timer.h"
+#include "move_ordering.h"
+#include "move_list.h"
 
 namespace rlop {
     // Implements the Alpha-Beta pruning algorithm, an optimization of the Minimax algorithm
     // for searching game trees. It is designed to reduce the number of nodes evaluated in the
     // search tree by pruning branches that are not likely to lead to better solutions than those
-    // already found.
+    // already found. Besides fixed-depth searches, it provides an iterative deepening driver, which
+    // searches with increasing depths under a time limit and tries the best move of the previous
+    // iteration first. The moves can be searched either with the full window or by the principal
+    // variation search (PVS), and the iterations can be searched with aspiration windows. The moves generated by the
+    // problem can be reordered dynamically by the killer and history heuristics, see OrderMoves(). With mate scoring, wins
+    // and losses are scored by their distances from the root, see set_mate_scoring().
     class AlphaBetaSearch : public BaseAlgorithm {
     public:
         // Defines the type of value returned by the AlphaBeta search.
@@ -16,12 +24,21 @@ namespace rlop {
             kNone
         };
 
+        // Defines how the moves of a node are searched.
+        enum class SearchMode {
+            kAlphaBeta = 0, // Every move is searched with the full window.
+            kPVS // The first move is searched with the full window, and the others with a null window first, which are
+                 // re-searched with the full window only if they improve alpha (a.k.a. NegaScout).
+        };
+
         // Constructor initializes the algorithm with the maximum possible score in the game.
         //
         // Parameters:
         //   max_score: The maximum score a player can achieve in the game. This is used to initialize
         //              the alpha and beta values for the root of the search tree.
-        AlphaBetaSearch(double max_score) : max_score_(max_score) {}
+        //   max_num_moves: The maximum number of moves of a position, which is the capacity of the move list of each
+        //                  ply. Default is 256.
+        AlphaBetaSearch(double max_score, Int max_num_moves = 256) : max_score_(max_score), move_stack_(max_num_moves) {}
 
         virtual ~AlphaBetaSearch() = default; 
 
@@ -31,8 +48,13 @@ namespace rlop {
         // Pure virtual function to check if the current game state is terminal (i.e., the game is over). 
         virtual bool IsTerminal() = 0;
 
-        // Pure virtual function to generate all possible moves from the current game state.
-        virtual std::vector<Int> GenerateMoves() = 0;
+        // Pure virtual function to generate all possible moves from the current game state. The moves are appended to a
+        // list owned by the search, which is empty and reused by all the positions at the same ply, so that no memory is
+        // allocated during the search.
+        //
+        // Parameters:
+        //   moves: The list to fill, whose capacity is the maximum number of moves given to the constructor.
+        virtual void GenerateMoves(MoveList* moves) = 0;
 
         // Pure virtual function tp make a move and updates the game state accordingly.
         //
@@ -50,7 +72,58 @@ namespace rlop {
         virtual void UndoMove(Int move) = 0;
 
         // Resets the algorithm.
-        virtual void Reset() override {}
+        virtual void Reset() override {
+            num_nodes_ = 0;
+            root_move_ = kIntNull;
+            aborted_ = false;
+            stopped_ = false;
+            ply_ = 0;
+            killers_.Reset();
+            history_.Reset();
+        }
+
+        // Orders the moves generated at a ply before they are searched. By default, if the move ordering is enabled, the
+        // moves are sorted in the descending order of MoveScore(), and the moves with equal scores keep the static order
+        // of GenerateMoves().
+        //
+        // Parameters:
+        //   moves: The moves to order.
+        //   ply: The ply of the position, where the root is at ply 0.
+        virtual void OrderMoves(MoveList* moves, Int ply) {
+            if (!move_ordering_ || moves->size() <= 1)
+                return;
+            scored_moves_.clear();
+            for (Int i=0; i<Int(moves->size()); ++i) {
+                scored_moves_.emplace_back(-MoveScore((*moves)[i], ply), i, (*moves)[i]);
+            }
+            std::sort(scored_moves_.begin(), scored_moves_.end());
+            for (Int i=0; i<Int(moves->size()); ++i) {
+                (*moves)[i] = std::get<2>(scored_moves_[i]);
+            }
+        }
+
+        // Returns the ordering score of a move at a ply. By default, the killer moves of the ply score the highest, the
+        // most recent first, and the other moves score their history scores. Override it to combine the heuristics with
+        // domain knowledge.
+        //
+        // Parameters:
+        //   move: The move to score.
+        //   ply: The ply of the position, where the root is at ply 0.
+        virtual Int MoveScore(Int move, Int ply) {
+            Int key = MoveKey(move);
+            Int slot = killers_.Find(ply, key);
+            return slot != kIntNull? kIntFull - slot : history_.Get(ply & 1, key);
+        }
+
+        // Returns the key of a move in the killer and history tables, which is the move itself by default. Override it
+        // if the effect of a move depends on the position, e.g., to key a move by the square it lands on. The key should
+        // be non-negative and small, as the history table is indexed by it.
+        //
+        // Parameters:
+        //   move: The move to key, which has not been made.
+        virtual Int MoveKey(Int move) {
+            return move;
+        }
 
         // Implements the Alpha-Beta pruning algorithm for a given depth, alpha, and beta values.
         //
@@ -62,23 +135,37 @@ namespace rlop {
         // Returns:
         //   double: The value of the node.
         virtual double AlphaBeta(Int depth, double alpha, double beta) {
+            if (!Visit())
+                return 0;
+            if (PruneMateDistance(&alpha, &beta))
+                return alpha;
             if (depth == 0 || IsTerminal())
-                return Evaluate();
+                return EvaluateLeaf();
             double value = -max_score_;
-            std::vector<Int> moves = GenerateMoves();
+            bool first = true;
+            MoveList& moves = move_stack_.Get(ply_);
+            GenerateMoves(&moves);
+            OrderMoves(&moves, ply_);
             for (Int mv : moves) {
                 if (!MakeMove(mv)) 
                     continue;
-                value = std::max(value, -AlphaBeta(depth - 1, -beta, -alpha));
+                value = std::max(value, SearchChild(depth, alpha, beta, first));
+                first = false;
                 UndoMove(mv);
+                if (aborted_)
+                    return 0;
                 alpha = std::max(alpha, value);
-                if (alpha >= beta) 
+                if (alpha >= beta) {
+                    RecordCutoff(mv, depth);
                     break;
+                }
             }
             return value;
         }
 
-        // Initiates the Alpha-Beta search algorithm to find the best move and its value from the current game state.
+        // Initiates the Alpha-Beta search algorithm to find the best move and its value from the current game state. The
+        // root moves are rotated by the root rotation, and the root move set by the iterative deepening, if any, is
+        // searched first.
         //
         // Parameters:
         //   depth: The maximum depth of the search tree to explore.
@@ -89,17 +176,26 @@ namespace rlop {
         //   std::pair<Int, double>: The best move and its value. If no move is found, returns {kIntNull, best_value}.
         virtual std::pair<Int, double> Search(Int depth, double alpha = std::numeric_limits<double>::lowest(), double beta = std::numeric_limits<double>::max()) {
             if (depth == 0 || IsTerminal())
-                return { kIntNull, Evaluate() };
+                return { kIntNull, EvaluateLeaf() };
             alpha = std::max(-max_score_, alpha);
             beta = std::min(max_score_, beta); 
             Int best_mv = kIntNull;
             double best_value = -max_score_;
-            std::vector<Int> moves = GenerateMoves();
+            bool first = true;
+            MoveList& moves = move_stack_.Get(ply_);
+            GenerateMoves(&moves);
+            OrderMoves(&moves, ply_);
+            if (root_rotation_ > 0 && !moves.empty())
+                std::rotate(moves.begin(), moves.begin() + root_rotation_ % moves.size(), moves.end());
+            MoveToFront(&moves, root_move_);
             for (Int mv : moves) {
                 if (!MakeMove(mv))
                     continue;
-                double value = -AlphaBeta(depth - 1, -beta, -alpha);
+                double value = SearchChild(depth, alpha, beta, first);
+                first = false;
                 UndoMove(mv);
+                if (aborted_)
+                    break;
                 if (value > best_value) {
                     best_value = value;
                     best_mv = mv;
@@ -111,7 +207,281 @@ namespace rlop {
             return { best_mv, best_value }; 
         }
 
+        // Searches with increasing depths from 1 to a maximum depth, starting each iteration from the best move of the
+        // previous one, until the maximum depth is completed, a win or a loss is proven, or the time limit is reached.
+        // An iteration interrupted by the time limit is discarded. If an aspiration window is set, each iteration after
+        // the first is searched within the window around the value of the previous one, and re-searched with the full
+        // window if its value falls outside.
+        //
+        // Parameters:
+        //   max_depth: The maximum depth, typically the number of moves left in the game.
+        //   time_limit: The time limit in milliseconds, checked every 1024 nodes. Default is kIntFull, i.e., no limit.
+        //
+        // Returns:
+        //   std::pair<Int, double>: The best move and its value of the deepest completed iteration. If no iteration is
+        //                           completed, returns {kIntNull, -max_score}.
+        virtual std::pair<Int, double> IterativeSearch(Int max_depth, int64_t time_limit = kIntFull) {
+            time_limit_ = time_limit;
+            aborted_ = false;
+            timer_.Restart();
+            std::pair<Int, double> best = { kIntNull, -max_score_ };
+            completed_depth_ = 0;
+            for (Int depth=1; depth<=max_depth; ++depth) {
+                root_move_ = best.first;
+                history_.Age();
+                std::pair<Int, double> result;
+                if (aspiration_window_ > 0 && depth > 1) {
+                    double alpha = std::max(-max_score_, best.second - aspiration_window_);
+                    double beta = std::min(max_score_, best.second + aspiration_window_);
+                    result = Search(depth, alpha, beta);
+                    if (!aborted_ && ((result.second <= alpha && alpha > -max_score_) || (result.second >= beta && beta < max_score_)))
+                        result = Search(depth);
+                }
+                else {
+                    result = Search(depth);
+                }
+                if (aborted_)
+                    break;
+                best = result;
+                completed_depth_ = depth;
+                if (IsMateScore(best.second))
+                    break;
+            }
+            timer_.Stop();
+            time_limit_ = kIntFull;
+            aborted_ = false;
+            root_move_ = kIntNull;
+            return best;
+        }
+
+        // Stops the search as soon as possible. It can be called from another thread, and the search remains stopped
+        // until the next reset.
+        void Stop() {
+            stopped_.store(true, std::memory_order_relaxed);
+        }
+
+        // Clears the stop flag and the abort it caused without resetting the search, e.g., to run another search after the
+        // previous one was stopped by another thread. It should not be called while a search is running.
+        void ClearStop() {
+            stopped_.store(false, std::memory_order_relaxed);
+            aborted_ = false;
+        }
+
+        // Returns true if the search has been stopped by Stop() since the last reset or ClearStop().
+        bool IsStopped() const {
+            return stopped_.load(std::memory_order_relaxed);
+        }
+
+        // Returns the number of nodes visited since the last reset.
+        Int num_nodes() const {
+            return num_nodes_;
+        }
+
+        // Returns true if a value is a proven win or loss, i.e., max_score or -max_score, or within the range of the mate
+        // scores if mate scoring is enabled.
+        bool IsMateScore(double value) const {
+            return std::abs(value) >= max_score_ - mate_step_ * max_mate_ply_;
+        }
+
+        // Returns the depth of the last completed iteration of IterativeSearch().
+        Int completed_depth() const {
+            return completed_depth_;
+        }
+
+        SearchMode mode() const {
+            return mode_;
+        }
+
+        bool move_ordering() const {
+            return move_ordering_;
+        }
+
+        double null_window() const {
+            return null_window_;
+        }
+
+        double aspiration_window() const {
+            return aspiration_window_;
+        }
+
+        Int root_rotation() const {
+            return root_rotation_;
+        }
+
+        double mate_step() const {
+            return mate_step_;
+        }
+
+        Int max_mate_ply() const {
+            return max_mate_ply_;
+        }
+
+        void set_mode(SearchMode mode) {
+            mode_ = mode;
+        }
+
+        // Enables or disables the reordering of the moves by the killer and history heuristics in OrderMoves().
+        void set_move_ordering(bool move_ordering) {
+            move_ordering_ = move_ordering;
+        }
+
+        // Sets the width of the null windows of PVS, which should be smaller than the smallest difference between two
+        // distinct scores.
+        void set_null_window(double null_window) {
+            null_window_ = null_window;
+        }
+
+        // Sets the half width of the aspiration windows of IterativeSearch(). A non-positive value disables them.
+        void set_aspiration_window(double aspiration_window) {
+            aspiration_window_ = aspiration_window;
+        }
+
+        // Sets the number of positions by which the root moves are rotated before they are searched, which makes the
+        // threads of a parallel search start from different moves.
+        void set_root_rotation(Int root_rotation) {
+            root_rotation_ = root_rotation;
+        }
+
+        // Enables the mate scoring, in which a win or a loss evaluated at a ply, i.e., a value of max_score or -max_score
+        // returned by Evaluate(), is moved toward zero by a step per ply from the root. The search then prefers the
+        // fastest wins and the slowest losses, and prunes the nodes that cannot improve on a mate already found. The
+        // values beyond max_score - step * max_ply are taken as mate scores, so the other values of Evaluate() should
+        // stay below them.
+        //
+        // Parameters:
+        //   step: The score of a ply. A non-positive value disables the mate scoring.
+        //   max_ply: The maximum number of plies from the root to a mate, e.g., the length of the longest game.
+        void set_mate_scoring(double step, Int max_ply) {
+            mate_step_ = std::max(step, 0.0);
+            max_mate_ply_ = mate_step_ > 0? max_ply : 0;
+        }
+
     protected:
+        // Counts a node and checks the stop flag and, every 1024 nodes, the time limit.
+        //
+        // Returns:
+        //   bool: Returns false if the search has been aborted by the time limit or stopped.
+        bool Visit() {
+            ++num_nodes_;
+            if (stopped_.load(std::memory_order_relaxed))
+                aborted_ = true;
+            else if (time_limit_ != kIntFull && (num_nodes_ & 1023) == 0 && timer_.Elapsed() >= time_limit_)
+                aborted_ = true;
+            return !aborted_;
+        }
+
+        // Searches the child reached by a move that has just been made, according to the search mode.
+        //
+        // Parameters:
+        //   depth: The depth of the parent node.
+        //   alpha: The alpha value of the parent node.
+        //   beta: The beta value of the parent node.
+        //   first: Whether it is the first move searched at the parent node.
+        //
+        // Returns:
+        //   double: The value of the child from the perspective of the parent.
+        double SearchChild(Int depth, double alpha, double beta, bool first) {
+            ++ply_;
+            double value;
+            if (mode_ == SearchMode::kAlphaBeta || first) {
+                value = -AlphaBeta(depth - 1, -beta, -alpha);
+            }
+            else {
+                value = -AlphaBeta(depth - 1, -alpha - null_window_, -alpha);
+                if (value > alpha && value < beta && !aborted_)
+                    value = -AlphaBeta(depth - 1, -beta, -alpha);
+            }
+            --ply_;
+            return value;
+        }
+
+        // Evaluates a leaf at the current ply, turning a win or a loss into a mate score if mate scoring is enabled.
+        double EvaluateLeaf() {
+            double value = Evaluate();
+            if (mate_step_ > 0) {
+                if (value >= max_score_)
+                    return max_score_ - ply_ * mate_step_;
+                else if (value <= -max_score_)
+                    return -max_score_ + ply_ * mate_step_;
+            }
+            return value;
+        }
+
+        // Narrows a window to the mate scores reachable from the current ply, which lie between a loss at this ply and a
+        // win at the next one, if mate scoring is enabled.
+        //
+        // Returns:
+        //   bool: Returns true if the window becomes empty, i.e., no reachable value is inside it. Alpha is then set to the
+        //         reachable bound beyond the window, which is the value to return.
+        bool PruneMateDistance(double* alpha, double* beta) const {
+            if (mate_step_ <= 0)
+                return false;
+            double upper = max_score_ - (ply_ + 1) * mate_step_;
+            *alpha = std::max(*alpha, -max_score_ + ply_ * mate_step_);
+            *beta = std::min(*beta, upper);
+            if (*alpha < *beta)
+                return false;
+            *alpha = std::min(*alpha, upper);
+            return true;
+        }
+
+        // Converts a value at the current ply into a value to store in a transposition table, whose mate scores count the
+        // plies from the stored position instead of the root, so that they remain valid wherever the position is reached.
+        double ValueToTable(double value) const {
+            if (mate_step_ <= 0 || !IsMateScore(value))
+                return value;
+            return value > 0? value + ply_ * mate_step_ : value - ply_ * mate_step_;
+        }
+
+        // Converts a value stored by ValueToTable() back into a value at the current ply.
+        double ValueFromTable(double value) const {
+            if (mate_step_ <= 0 || !IsMateScore(value))
+                return value;
+            return value > 0? value - ply_ * mate_step_ : value + ply_ * mate_step_;
+        }
+
+        // Records a move that caused a beta cutoff at the current ply in the killer and history tables.
+        //
+        // Parameters:
+        //   move: The move that caused the cutoff.
+        //   depth: The remaining depth of the position.
+        void RecordCutoff(Int move, Int depth) {
+            if (!move_ordering_)
+                return;
+            Int key = MoveKey(move);
+            killers_.Update(ply_, key);
+            history_.Update(ply_ & 1, key, depth);
+        }
+
+        // Moves a move to the front of a list of moves, keeping the order of the others. Does nothing if the move is not
+        // in the list.
+        static void MoveToFront(MoveList* moves, Int move) {
+            if (move == kIntNull)
+                return;
+            auto it = std::find(moves->begin(), moves->end(), move);
+            if (it != moves->end())
+                std::rotate(moves->begin(), it, it + 1);
+        }
+
         double max_score_; 
+        Int num_nodes_ = 0;
+        Int root_move_ = kIntNull;
+        Int completed_depth_ = 0;
+        int64_t time_limit_ = kIntFull;
+        bool aborted_ = false;
+        SearchMode mode_ = SearchMode::kAlphaBeta;
+        double null_window_ = 1e-6;
+        double aspiration_window_ = 0;
+        Int root_rotation_ = 0;
+        double mate_step_ = 0;
+        Int max_mate_ply_ = 0;
+        Int ply_ = 0;
+        bool move_ordering_ = false;
+        KillerTable<> killers_;
+        HistoryTable history_;
+        std::vector<std::tuple<Int, Int, Int>> scored_moves_;
+        MoveStack move_stack_;
+        std::atomic<bool> stopped_ = false;
+        Timer<> timer_;
     };
 }
\ No newline at end of file
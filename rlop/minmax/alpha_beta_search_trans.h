@@ -5,6 +5,9 @@ namespace rlop {
     // Extends the AlphaBetaSearch class to include transposition table support, optimizing the search process by storing
     // and reusing the results of previously evaluated positions. This template class allows for a customizable key type,
     // enabling the use of various methods for encoding game states into keys suitable for transposition table lookups.
+    // The best move found at a position can be stored with its value and is searched first when the position is visited
+    // again, e.g., by the next iteration of IterativeSearch(). Mate scores are stored relative to the position, see
+    // ValueToTable().
     template<typename TKey>
     class AlphaBetaSearchTrans : public AlphaBetaSearch {
     public:
@@ -12,7 +15,8 @@ namespace rlop {
         //
         // Parameters:
         //   max_score: The maximum possible score in the game, used to initialize alpha-beta bounds.
-        AlphaBetaSearchTrans(double max_score) : AlphaBetaSearch(max_score) {}
+        //   max_num_moves: The maximum number of moves of a position. Default is 256.
+        AlphaBetaSearchTrans(double max_score, Int max_num_moves = 256) : AlphaBetaSearch(max_score, max_num_moves) {}
 
         virtual ~AlphaBetaSearchTrans() = default;
 
@@ -43,6 +47,76 @@ namespace rlop {
         //   type: The type of the value (exact, lower bound, or upper bound).
         virtual void UpdateTable(const TKey& key, Int depth, double value, ValueType type) = 0;
 
+        // Updates the transposition table with a new value together with the best move found at the position. The default
+        // ignores the move.
+        //
+        // Parameters:
+        //   key: The key representing the game state being updated.
+        //   depth: The depth at which the value was evaluated.
+        //   value: The evaluated value of the position.
+        //   type: The type of the value (exact, lower bound, or upper bound).
+        //   move: The best move found at the position, or kIntNull if no move was searched.
+        virtual void UpdateTable(const TKey& key, Int depth, double value, ValueType type, Int) {
+            UpdateTable(key, depth, value, type);
+        }
+
+        // Returns the best move stored for a position regardless of its depth, which is searched first. The default
+        // returns kIntNull.
+        //
+        // Parameters:
+        //   key: The encoded key representing the current game state.
+        virtual Int GetBestMove(const TKey&) {
+            return kIntNull;
+        }
+
+        // Searches to a given depth by MTD(f), an alternative to Search() made of null-window searches only. Each probe
+        // tests whether the value reaches a bound, which moves the lower or the upper bound of the value to the returned
+        // value, until the bounds meet. The probes revisit the same positions, whose bounds are reused from the
+        // transposition table. It is fastest when the guess is close to the value, e.g., the value of the previous
+        // iteration, or when the values are few, e.g., a win, a draw or a loss. With many distinct values, such as
+        // mate scores, bisection bounds the number of probes by the logarithm of their count.
+        //
+        // Parameters:
+        //   depth: The maximum depth of the search.
+        //   guess: The first guess of the value. Default is 0.
+        //   bisection: Whether to probe the middle of the bounds instead of the last value after the first probe. Default
+        //              is false.
+        //
+        // Returns:
+        //   std::pair<Int, double>: The best move and its value. The move is kIntNull if no probe proves a lower bound,
+        //                           e.g., for a lost position. If the search is aborted, returns the best move and value
+        //                           of the completed probes.
+        virtual std::pair<Int, double> MTDSearch(Int depth, double guess = 0, bool bisection = false) {
+            double lower = -max_score_;
+            double upper = max_score_;
+            double value = std::clamp(guess, lower, upper);
+            Int best_mv = kIntNull;
+            num_probes_ = 0;
+            while (lower < upper) {
+                double beta = value == lower? value + null_window_ : value;
+                if (bisection && num_probes_ > 0)
+                    beta = std::max((lower + upper) / 2, lower + null_window_);
+                auto [mv, result] = Search(depth, beta - null_window_, beta);
+                if (aborted_)
+                    break;
+                ++num_probes_;
+                value = result;
+                if (value < beta) {
+                    upper = value;
+                }
+                else {
+                    lower = value;
+                    best_mv = mv;
+                }
+            }
+            return { best_mv, value };
+        }
+
+        // Returns the number of null-window searches of the last MTDSearch().
+        Int num_probes() const {
+            return num_probes_;
+        }
+
         // Overrides the AlphaBeta method to integrate transposition table lookups and updates, enhancing the search efficiency 
         // by reusing results of previously evaluated positions. This implementation checks the transposition table before 
         // proceeding with the standard AlphaBeta search logic. There is a discussion on how to combine negamax and transposition 
@@ -56,11 +130,16 @@ namespace rlop {
         // Returns:
         //   double: The evaluated value of the current position.
         virtual double AlphaBeta(Int depth, double alpha, double beta) override {
+            if (!Visit())
+                return 0;
+            if (PruneMateDistance(&alpha, &beta))
+                return alpha;
             double origin_alpha = alpha;
             TKey key = PositionEncode();
             auto trans = Transpose(key, depth);
             if (trans) {
                 auto [value, type] = *trans;
+                value = ValueFromTable(value);
                 if (type == ValueType::kExact) 
                     return value;
                 else if (type == ValueType::kLowerBound)
@@ -71,27 +150,42 @@ namespace rlop {
                     return value;
             }
             if (depth == 0 || IsTerminal())
-                return Evaluate();
+                return EvaluateLeaf();
             double value = -max_score_;
-            std::vector<Int> moves = GenerateMoves();
+            Int best_mv = kIntNull;
+            MoveList& moves = move_stack_.Get(ply_);
+            GenerateMoves(&moves);
+            OrderMoves(&moves, ply_);
+            MoveToFront(&moves, GetBestMove(key));
             for (Int mv : moves) {
                 if (!MakeMove(mv)) 
                     continue;
-                value = std::max(value, -AlphaBeta(depth - 1, -beta, -alpha));
+                double child_value = SearchChild(depth, alpha, beta, best_mv == kIntNull);
                 UndoMove(mv);
+                if (aborted_)
+                    return 0;
+                if (child_value > value || best_mv == kIntNull) {
+                    value = std::max(value, child_value);
+                    best_mv = mv;
+                }
                 alpha = std::max(alpha, value);
-                if (alpha >= beta) 
+                if (alpha >= beta) {
+                    RecordCutoff(mv, depth);
                     break;
+                }
             }
             ValueType type;
             if (value <= origin_alpha)
                 type = ValueType::kUpperBound;
-            if (value >= beta)
+            else if (value >= beta)
                 type = ValueType::kLowerBound;
             else
                 type = ValueType::kExact;
-            UpdateTable(key, depth, value, type);
+            UpdateTable(key, depth, ValueToTable(value), type, best_mv);
             return value;
         }
+
+    protected:
+        Int num_probes_ = 0;
     };
 }
\ No newline at end of file
@@ -0,0 +1,120 @@
+#pragma once
+#include "alpha_beta_search.h"
+
+namespace rlop {
+    // Implements the Lazy SMP parallelization of alpha-beta searches. Each thread runs the same search with its own copy
+    // of the problem, and the searches share nothing but a transposition table, through which the values and best moves
+    // found by a thread prune and order the trees of the others. The root moves of the i-th thread are rotated by i, so
+    // that the helper threads fill the table ahead of the main thread instead of following it. The search ends as soon as
+    // any thread completes, whose result is returned, and the other threads are stopped.
+    //
+    // Template Parameters:
+    //   TSearch: The search of a thread, derived from AlphaBetaSearch. The derived class creates one search per thread
+    //            in searches_, and the searches should share a transposition table safe for concurrent access, e.g.,
+    //            SharedTransposition or BucketTransposition.
+    template<typename TSearch>
+    class LazySMPSearch : public BaseAlgorithm {
+    public:
+        LazySMPSearch() = default;
+
+        virtual ~LazySMPSearch() = default;
+
+        // Resets the searches of all the threads.
+        virtual void Reset() override {
+            for (auto& search : searches_) {
+                search->Reset();
+            }
+            winner_ = kIntNull;
+        }
+
+        // Searches to a given depth in parallel. See AlphaBetaSearch::Search().
+        //
+        // Parameters:
+        //   depth: The maximum depth of the search tree to explore.
+        //
+        // Returns:
+        //   std::pair<Int, double>: The best move and its value found by the first thread that completes.
+        virtual std::pair<Int, double> Search(Int depth) {
+            return Run([depth](TSearch* search) { return search->Search(depth); });
+        }
+
+        // Searches with increasing depths in parallel. See AlphaBetaSearch::IterativeSearch().
+        //
+        // Parameters:
+        //   max_depth: The maximum depth, typically the number of moves left in the game.
+        //   time_limit: The time limit in milliseconds of each thread. Default is kIntFull, i.e., no limit.
+        //
+        // Returns:
+        //   std::pair<Int, double>: The best move and its value found by the first thread that completes.
+        virtual std::pair<Int, double> IterativeSearch(Int max_depth, int64_t time_limit = kIntFull) {
+            return Run([max_depth, time_limit](TSearch* search) { return search->IterativeSearch(max_depth, time_limit); });
+        }
+
+        // Stops the searches of all the threads.
+        void Stop() {
+            for (auto& search : searches_) {
+                search->Stop();
+            }
+        }
+
+        Int num_threads() const {
+            return searches_.size();
+        }
+
+        // Returns the total number of nodes visited by all the threads since the last reset.
+        Int num_nodes() const {
+            Int num_nodes = 0;
+            for (const auto& search : searches_) {
+                num_nodes += search->num_nodes();
+            }
+            return num_nodes;
+        }
+
+        // Returns the index of the thread whose result was returned by the last search, or kIntNull.
+        Int winner() const {
+            return winner_;
+        }
+
+        const TSearch& search(Int thread_i) const {
+            return *searches_[thread_i];
+        }
+
+        TSearch& search(Int thread_i) {
+            return *searches_[thread_i];
+        }
+
+    protected:
+        // Runs a search in every thread and returns the result of the first thread that completes, i.e., is not stopped
+        // by another thread. Without OpenMP, the first search completes and the others return immediately. The stop
+        // flags left by the previous run are cleared first, so the searches can run again without a reset.
+        //
+        // Parameters:
+        //   func: The search to run, which takes the search of a thread.
+        template<typename TFunc>
+        std::pair<Int, double> Run(TFunc&& func) {
+            std::pair<Int, double> best = { kIntNull, 0 };
+            winner_ = kIntNull;
+            // Cleared before any thread starts, so that a late thread cannot clear the stop of this run's winner.
+            for (auto& search : searches_) {
+                search->ClearStop();
+            }
+            #pragma omp parallel for num_threads(num_threads()) schedule(static, 1)
+            for (Int i=0; i<num_threads(); ++i) {
+                searches_[i]->set_root_rotation(i);
+                auto result = func(searches_[i].get());
+                #pragma omp critical
+                {
+                    if (winner_ == kIntNull && !searches_[i]->IsStopped()) {
+                        winner_ = i;
+                        best = result;
+                        Stop();
+                    }
+                }
+            }
+            return best;
+        }
+
+        std::vector<std::unique_ptr<TSearch>> searches_;
+        Int winner_ = kIntNull;
+    };
+}
\ No newline at end of file
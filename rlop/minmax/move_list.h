@@ -0,0 +1,95 @@
+#pragma once
+#include <cassert>
+#include <deque>
+#include "rlop/common/arena.h"
+
+namespace rlop {
+    // A list of moves with a fixed capacity, whose storage is not owned by the list. It mirrors the part of the
+    // std::vector interface used by the searches, so that the moves of a position can be generated without allocating.
+    // The capacity should bound the number of moves of any position, which is only asserted in debug builds.
+    class MoveList {
+    public:
+        MoveList(Int* data, size_t capacity) : data_(data), capacity_(capacity) {}
+
+        void push_back(Int move) {
+            assert(size_ < capacity_ && "MoveList: push back on full list.");
+            data_[size_++] = move;
+        }
+
+        void clear() {
+            size_ = 0;
+        }
+
+        bool empty() const {
+            return size_ == 0;
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+        size_t capacity() const {
+            return capacity_;
+        }
+
+        Int& operator[](size_t i) {
+            return data_[i];
+        }
+
+        const Int& operator[](size_t i) const {
+            return data_[i];
+        }
+
+        Int* begin() {
+            return data_;
+        }
+
+        Int* end() {
+            return data_ + size_;
+        }
+
+        const Int* begin() const {
+            return data_;
+        }
+
+        const Int* end() const {
+            return data_ + size_;
+        }
+
+    private:
+        Int* data_;
+        size_t capacity_;
+        size_t size_ = 0;
+    };
+
+    // Keeps one MoveList per ply of a search, allocated from an arena the first time the ply is reached and reused by
+    // all the later positions at the same ply. The lists stay valid while the deeper plies are searched.
+    class MoveStack {
+    public:
+        // Parameters:
+        //   capacity: The maximum number of moves of a position.
+        MoveStack(size_t capacity) : capacity_(capacity), arena_(capacity * 64) {}
+
+        // Returns the list of a ply after clearing it.
+        //
+        // Parameters:
+        //   ply: The ply of the position, where the root is at ply 0.
+        MoveList& Get(Int ply) {
+            while (ply >= Int(lists_.size())) {
+                lists_.emplace_back(arena_.Allocate(capacity_), capacity_);
+            }
+            MoveList& moves = lists_[ply];
+            moves.clear();
+            return moves;
+        }
+
+        size_t capacity() const {
+            return capacity_;
+        }
+
+    private:
+        size_t capacity_;
+        Arena<Int> arena_;
+        std::deque<MoveList> lists_;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+#pragma once
+#include "rlop/common/typedef.h"
+
+namespace rlop {
+    // Keeps the killer moves of each ply, i.e., the last moves that caused a beta cutoff at the same ply in other
+    // branches of the tree. A killer move is likely to refute the other positions at that ply as well, so it is worth
+    // searching early.
+    //
+    // Template Parameters:
+    //   kNumSlots: The number of killer moves kept per ply.
+    template<Int kNumSlots = 2>
+    class KillerTable {
+    public:
+        KillerTable() = default;
+
+        virtual ~KillerTable() = default;
+
+        void Reset() {
+            killers_.clear();
+        }
+
+        // Records a move that caused a beta cutoff at a ply, which becomes the first killer of the ply.
+        //
+        // Parameters:
+        //   ply: The ply of the position, where the root is at ply 0.
+        //   move: The move that caused the cutoff.
+        void Update(Int ply, Int move) {
+            if (ply >= Int(killers_.size())) {
+                std::array<Int, kNumSlots> empty;
+                empty.fill(kIntNull);
+                killers_.resize(ply + 1, empty);
+            }
+            auto& killers = killers_[ply];
+            auto it = std::find(killers.begin(), killers.end(), move);
+            if (it == killers.end())
+                it = killers.end() - 1;
+            std::rotate(killers.begin(), it, it + 1);
+            killers[0] = move;
+        }
+
+        // Returns the slot of a killer move at a ply, where slot 0 is the most recent one, or kIntNull if the move is not
+        // a killer of the ply.
+        Int Find(Int ply, Int move) const {
+            if (ply >= Int(killers_.size()))
+                return kIntNull;
+            const auto& killers = killers_[ply];
+            for (Int i=0; i<kNumSlots; ++i) {
+                if (killers[i] == move)
+                    return i;
+            }
+            return kIntNull;
+        }
+
+    protected:
+        std::vector<std::array<Int, kNumSlots>> killers_;
+    };
+
+    // Keeps the history scores of moves, a.k.a. the butterfly table. Each beta cutoff adds a bonus growing with the
+    // remaining depth to the score of the move for the side to move, regardless of the position, so the moves that
+    // refute many positions are searched early everywhere. Only non-negative moves are scored.
+    class HistoryTable {
+    public:
+        static constexpr Int kMaxBonusDepth = 32;
+
+        HistoryTable() = default;
+
+        virtual ~HistoryTable() = default;
+
+        void Reset() {
+            for (auto& scores : scores_) {
+                scores.clear();
+            }
+        }
+
+        // Halves all the scores, so that the cutoffs of the previous searches weigh less than those of the next one.
+        void Age() {
+            for (auto& scores : scores_) {
+                for (auto& score : scores) {
+                    score /= 2;
+                }
+            }
+        }
+
+        // Adds the bonus of a beta cutoff to the score of a move.
+        //
+        // Parameters:
+        //   side: The side to move, 0 or 1.
+        //   move: The move that caused the cutoff.
+        //   depth: The remaining depth at which the cutoff occurred. Depths beyond kMaxBonusDepth, e.g., of a search to
+        //          the end of the game, get the bonus of kMaxBonusDepth.
+        void Update(Int side, Int move, Int depth) {
+            if (move < 0)
+                return;
+            auto& scores = scores_[side];
+            if (move >= Int(scores.size()))
+                scores.resize(move + 1, 0);
+            depth = std::min(depth, kMaxBonusDepth);
+            scores[move] += depth * depth;
+        }
+
+        Int Get(Int side, Int move) const {
+            const auto& scores = scores_[side];
+            return move >= 0 && move < Int(scores.size())? scores[move] : 0;
+        }
+
+    protected:
+        std::array<std::vector<Int>, 2> scores_;
+    };
+}
\ No newline at end of file
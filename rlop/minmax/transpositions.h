@@ -1,4 +1,5 @@
 #pragma once
+#include "rlop/common/platform.h"
 #include "alpha_beta_search_trans.h"
 
 namespace rlop {
@@ -12,6 +13,7 @@ namespace rlop {
             Int depth;
             double value;
             Type type = Type::kNone;
+            Int move = kIntNull; // The best move found at the position.
         };
 
         CircularTransposition(size_t size) : vec_(size) {}
@@ -41,4 +43,268 @@ namespace rlop {
     protected:
         std::vector<Item> vec_;
     };
+
+    // An entry of the lock-free transposition tables. The item is packed into a 64-bit word, which is stored together
+    // with its XOR with the key. An item torn by concurrent writes fails this check and reads as an item of another
+    // position instead of a corrupted one of the probed position. The value is stored as a float, a move outside
+    // [0, 1022] is dropped, and a depth between 32767 and kIntFull - 32767 is lowered to 32767.
+    //
+    // Template Parameters:
+    //   TKey: An unsigned integer type of at most 64 bits.
+    template<typename TKey>
+    struct alignas(16) TranspositionEntry {
+        using Type = typename AlphaBetaSearch::ValueType;
+        using Item = typename CircularTransposition<TKey>::Item;
+
+        static_assert(std::is_unsigned_v<TKey> && sizeof(TKey) <= sizeof(uint64_t));
+
+        static constexpr uint64_t kMaxDepth = 0x7FFF;
+        static constexpr uint64_t kMaxMove = 0x3FE;
+        static constexpr uint64_t kNumGenerations = 16;
+
+        std::atomic<uint64_t> check{ 0 };
+        std::atomic<uint64_t> data{ 0 };
+
+        void Clear() {
+            check.store(0, std::memory_order_relaxed);
+            data.store(0, std::memory_order_relaxed);
+        }
+
+        // Stores an item with its key and the generation of the search that found it.
+        void Store(TKey key, const Item& item, uint64_t generation = 0) {
+            uint64_t word = Pack(item, generation);
+            check.store((uint64_t)key ^ word, std::memory_order_relaxed);
+            data.store(word, std::memory_order_relaxed);
+        }
+
+        // Returns the stored item. Its lock is the key it was stored with, so it should be compared with the key before
+        // the item is used.
+        Item Load() const {
+            uint64_t word = data.load(std::memory_order_relaxed);
+            Item item = Unpack(word);
+            item.lock = (TKey)(check.load(std::memory_order_relaxed) ^ word);
+            return item;
+        }
+
+        // Returns true if an item of a key is stored, loading its packed word. Only the word of a matching item has to
+        // be unpacked.
+        bool Match(TKey key, uint64_t* word) const {
+            *word = data.load(std::memory_order_relaxed);
+            return (*word & 3) != 0 && (check.load(std::memory_order_relaxed) ^ *word) == (uint64_t)key;
+        }
+
+        // Returns the depth of a packed item.
+        static Int Depth(uint64_t word) {
+            uint64_t depth = (word >> 16) & 0xFFFF;
+            return depth & 0x8000? kIntFull - (Int)(depth & kMaxDepth) : (Int)depth;
+        }
+
+        // Returns the generation of a packed item.
+        static uint64_t Generation(uint64_t word) {
+            return (word >> 2) & (kNumGenerations - 1);
+        }
+
+        // Packs the value into bits 32-63, the depth into bits 16-31, the move plus one into bits 6-15, the generation
+        // into bits 2-5 and the type plus one into bits 0-1, so that an empty word reads as an item of type kNone. The
+        // depths close to kIntFull, i.e., of the searches to the end of the game, are stored as their distances to
+        // kIntFull with the top bit set.
+        static uint64_t Pack(const Item& item, uint64_t generation) {
+            float value = (float)item.value;
+            uint32_t value_bits;
+            std::memcpy(&value_bits, &value, sizeof(value_bits));
+            uint64_t depth = std::min((uint64_t)item.depth, kMaxDepth);
+            if (item.depth >= kIntFull - (Int)kMaxDepth)
+                depth = 0x8000 | (uint64_t)(kIntFull - item.depth);
+            uint64_t move = item.move >= 0 && item.move <= (Int)kMaxMove? item.move + 1 : 0;
+            uint64_t type = ((uint64_t)item.type + 1) & 3;
+            return ((uint64_t)value_bits << 32) | (depth << 16) | (move << 6) | ((generation & (kNumGenerations - 1)) << 2) | type;
+        }
+
+        static Item Unpack(uint64_t word) {
+            Item item;
+            uint32_t value_bits = (uint32_t)(word >> 32);
+            float value;
+            std::memcpy(&value, &value_bits, sizeof(value));
+            item.value = value;
+            item.depth = Depth(word);
+            uint64_t move = (word >> 6) & 0x3FF;
+            item.move = move == 0? kIntNull : (Int)move - 1;
+            item.type = (Type)((word + 3) & 3);
+            return item;
+        }
+    };
+
+    // A transposition table shared by the threads of a parallel search without locks, with one TranspositionEntry per
+    // slot. The items have the same semantics as those of CircularTransposition, within the limits of the entry.
+    //
+    // Template Parameters:
+    //   TKey: An unsigned integer type of at most 64 bits.
+    template<typename TKey>
+    class SharedTransposition {
+    public:
+        using Type = typename AlphaBetaSearch::ValueType;
+        using Entry = TranspositionEntry<TKey>;
+        using Item = typename Entry::Item;
+
+        SharedTransposition(size_t size) : size_(size), entries_(new Entry[size]) {}
+
+        virtual ~SharedTransposition() = default;
+
+        // Resets the table. It should not be called while the table is being searched.
+        virtual void Reset() {
+            for (size_t i=0; i<size_; ++i) {
+                entries_[i].Clear();
+            }
+        }
+
+        virtual void Save(TKey key, const Item& item) {
+            entries_[key % size_].Store(key, item);
+        }
+
+        // Returns the item in the slot of a key. Its lock is the key it was saved with, so it should be compared with the
+        // key before the item is used.
+        virtual Item Get(TKey key) const {
+            return entries_[key % size_].Load();
+        }
+
+        // Prefetches the slot of a key, so that a later probe of the key does not wait for the memory.
+        void Prefetch(TKey key) const {
+            rlop::Prefetch(&entries_[key % size_]);
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+    protected:
+        size_t size_;
+        std::unique_ptr<Entry[]> entries_;
+    };
+
+    // A transposition table of buckets of four entries, each bucket filling a 64-byte cache line, so a probe of a key
+    // looks at four candidate slots for the cost of one memory access. The first three entries of a bucket are
+    // depth-preferred, i.e., an item only replaces the shallowest of them if it is at least as deep or the replaced
+    // item is from an older generation, and the last one is always replaced by the items that are not deep enough. The
+    // generation is advanced by NewGeneration() between searches, so that the table can be kept across them while the
+    // items of the previous searches give way to the current one. Like SharedTransposition, it is lock-free and can be
+    // shared by the threads of a parallel search.
+    //
+    // Template Parameters:
+    //   TKey: An unsigned integer type of at most 64 bits.
+    template<typename TKey>
+    class BucketTransposition {
+    public:
+        using Type = typename AlphaBetaSearch::ValueType;
+        using Entry = TranspositionEntry<TKey>;
+        using Item = typename Entry::Item;
+
+        static constexpr size_t kBucketSize = 4;
+
+        struct alignas(64) Bucket {
+            Entry entries[kBucketSize];
+        };
+
+        // Constructs a BucketTransposition.
+        //
+        // Parameters:
+        //   size: The number of entries, which is rounded up to a multiple of the bucket size.
+        BucketTransposition(size_t size) : 
+            num_buckets_(std::max(size_t(1), (size + kBucketSize - 1) / kBucketSize)), 
+            buckets_(new Bucket[num_buckets_]) 
+        {}
+
+        virtual ~BucketTransposition() = default;
+
+        // Resets the table. It should not be called while the table is being searched.
+        virtual void Reset() {
+            for (size_t i=0; i<num_buckets_; ++i) {
+                for (auto& entry : buckets_[i].entries) {
+                    entry.Clear();
+                }
+            }
+            generation_ = 0;
+        }
+
+        // Advances the generation, which makes the items saved before replaceable regardless of their depths. It should
+        // not be called while the table is being searched.
+        void NewGeneration() {
+            generation_ = (generation_ + 1) % Entry::kNumGenerations;
+        }
+
+        // Saves an item. An item of the same key in a depth-preferred entry is replaced only by an item at least as deep,
+        // and an empty or old entry is taken before the shallowest one. An item of the same key in the always-replaced
+        // entry is replaced in place, or cleared when the item moves to a depth-preferred entry, so the bucket does not
+        // keep a stale copy of the key.
+        virtual void Save(TKey key, const Item& item) {
+            Bucket& bucket = buckets_[key % num_buckets_];
+            Entry& last = bucket.entries[kBucketSize - 1];
+            uint64_t word;
+            bool last_match = last.Match(key, &word);
+            Entry* victim = nullptr;
+            Int victim_depth = kIntFull;
+            for (size_t i=0; i+1<kBucketSize; ++i) {
+                Entry& entry = bucket.entries[i];
+                bool match = entry.Match(key, &word);
+                bool aged = (word & 3) == 0 || Entry::Generation(word) != generation_;
+                if (match) {
+                    if (aged || Entry::Depth(word) <= item.depth) {
+                        entry.Store(key, item, generation_);
+                        if (last_match)
+                            last.Clear();
+                    }
+                    else {
+                        last.Store(key, item, generation_);
+                    }
+                    return;
+                }
+                Int depth = aged? kIntNull : Entry::Depth(word);
+                if (depth < victim_depth) {
+                    victim = &entry;
+                    victim_depth = depth;
+                }
+            }
+            if (victim != nullptr && victim_depth <= item.depth) {
+                victim->Store(key, item, generation_);
+                if (last_match)
+                    last.Clear();
+            }
+            else {
+                last.Store(key, item, generation_);
+            }
+        }
+
+        // Returns the item of a key if it is in the bucket of the key, or otherwise an empty item, whose lock is not the
+        // key.
+        virtual Item Get(TKey key) const {
+            const Bucket& bucket = buckets_[key % num_buckets_];
+            uint64_t word;
+            for (const auto& entry : bucket.entries) {
+                if (entry.Match(key, &word)) {
+                    Item item = Entry::Unpack(word);
+                    item.lock = key;
+                    return item;
+                }
+            }
+            return Item{ (TKey)~key, 0, 0, Type::kNone, kIntNull };
+        }
+
+        // Prefetches the bucket of a key, so that a later probe of the key does not wait for the memory.
+        void Prefetch(TKey key) const {
+            rlop::Prefetch(&buckets_[key % num_buckets_]);
+        }
+
+        // Returns the number of entries.
+        size_t size() const {
+            return num_buckets_ * kBucketSize;
+        }
+
+        uint64_t generation() const {
+            return generation_;
+        }
+
+    protected:
+        size_t num_buckets_;
+        std::unique_ptr<Bucket[]> buckets_;
+        uint64_t generation_ = 0;
+    };
 }
\ No newline at end of file
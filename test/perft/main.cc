@@ -0,0 +1,177 @@
+#include "problems/connect4/board.h"
+#include "problems/snake/engine.h"
+#include "examples/snake/rollout.h"
+#include "rlop/common/timer.h"
+
+// Counts the allocations of the whole program, so that the benchmarks can report the allocations per node. The whole
+// family of the replaceable operators is replaced, so that every pointer is allocated by malloc() and freed by free().
+static std::atomic<int64_t> num_allocs = 0;
+
+static void* CountedAlloc(size_t size) {
+    ++num_allocs;
+    if (void* ptr = std::malloc(size == 0? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size) {
+    return CountedAlloc(size);
+}
+
+void* operator new[](size_t size) {
+    return CountedAlloc(size);
+}
+
+// GCC pairs free() with the operator new it sees inlined into the callers and reports a mismatch, although both sides
+// are replaced here consistently.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+// Measures a benchmark that returns the number of nodes it has visited, and prints the number of nodes, the nodes per
+// second and the allocations per node.
+template<typename Func>
+void Run(const std::string& name, Func&& func) {
+    rlop::Timer<std::chrono::microseconds> timer;
+    int64_t allocs = num_allocs;
+    timer.Restart();
+    int64_t num_nodes = func();
+    timer.Stop();
+    allocs = num_allocs - allocs;
+    std::cout << name << ": nodes: " << num_nodes
+        << ", duration: " << timer.duration() / 1000
+        << ", nodes/sec: " << static_cast<int64_t>(num_nodes * 1e6 / std::max(timer.duration(), int64_t(1)))
+        << ", allocs/node: " << static_cast<double>(allocs) / std::max(num_nodes, int64_t(1)) << std::endl;
+}
+
+// Counts the positions reached by all the move sequences of a depth from a position, in which a won or full board is
+// not expanded.
+int64_t Perft(connect4::Board& board, int depth) {
+    if (depth == 0)
+        return 1;
+    int64_t num_nodes = 0;
+    for (int col=0; col<connect4::Board::kWidth_; ++col) {
+        if (!board.MakeMove(col))
+            continue;
+        num_nodes += board.Win() || board.IsFull()? 1 : Perft(board, depth - 1);
+        board.UndoMove(col);
+    }
+    return num_nodes;
+}
+
+// Plays random games from the initial position and counts the moves.
+int64_t Connect4Playouts(int64_t num_playouts, uint64_t seed) {
+    rlop::Random rand(seed);
+    connect4::Board board;
+    int64_t num_nodes = 0;
+    for (int64_t i=0; i<num_playouts; ++i) {
+        board.Reset();
+        while (!board.Win() && !board.IsFull()) {
+            int col;
+            do {
+                col = rand.UniformIndex(connect4::Board::kWidth_);
+            } while (!board.IsPlayable(col));
+            board.MakeMove(col);
+            ++num_nodes;
+        }
+    }
+    return num_nodes;
+}
+
+// Plays random games of snakes, which avoid the moves that collide at once if they can, and counts the steps.
+int64_t SnakePlayouts(int64_t num_playouts, rlop::Int num_snakes, uint64_t seed) {
+    rlop::Random rand(seed);
+    snake::Engine engine(num_snakes);
+    engine.set_seed(seed);
+    int64_t num_nodes = 0;
+    std::array<rlop::Int, 4> dirs;
+    for (int64_t i=0; i<num_playouts; ++i) {
+        engine.Reset();
+        while (!engine.IsEnd()) {
+            for (rlop::Int snake_i=0; snake_i<num_snakes; ++snake_i) {
+                if (!engine.snakes()[snake_i].alive)
+                    continue;
+                rlop::Int num_dirs = 0;
+                for (rlop::Int dir=0; dir<4; ++dir) {
+                    if (engine.Lookahead(snake_i, dir))
+                        dirs[num_dirs++] = dir;
+                }
+                if (num_dirs > 0)
+                    engine.SetDir(snake_i, dirs[rand.UniformIndex(num_dirs)]);
+            }
+            engine.Update();
+            ++num_nodes;
+        }
+    }
+    return num_nodes;
+}
+
+// Runs the rollouts of snake MCTS from fresh engines of a snake, with a number of playouts per leaf as in
+// snake::MCTS, and counts the rollouts.
+int64_t SnakeRollouts(int64_t num_leaves, int64_t num_playouts, rlop::Int max_depth, uint64_t seed) {
+    rlop::Random rand(seed);
+    snake::Engine engine(1);
+    snake::Rollout rollout;
+    double total_reward = 0;
+    for (int64_t i=0; i<num_leaves; ++i) {
+        engine.set_seed(seed + i);
+        engine.Reset();
+        rollout.Load(engine, 0, max_depth);
+        for (int64_t j=0; j<num_playouts; ++j) {
+            rollout.Restart();
+            while (rollout.Step(rand));
+            total_reward += rollout.Reward();
+        }
+    }
+    if (total_reward < 0)
+        std::cout << "unexpected negative reward" << std::endl;
+    return num_leaves * num_playouts;
+}
+
+// Runs perft-style tree walks and random playouts with fixed seeds on the problem kernels that the searches depend on,
+// i.e., MakeMove(), UndoMove() and Win() of connect4::Board and Update() of snake::Engine, and on snake::Rollout,
+// whose nodes are the rollouts.
+//
+// Usage: test_perft [perft_depth] [num_playouts]
+int main(int argc, char *argv[]) {
+    int depth = argc > 1? std::stoi(argv[1]) : 8;
+    int64_t num_playouts = argc > 2? std::stoll(argv[2]) : 1000000;
+    uint64_t seed = 0;
+
+    for (int d=1; d<=depth; ++d) {
+        connect4::Board board;
+        board.Reset();
+        Run("connect4 perft " + std::to_string(d), [&]() { return Perft(board, d); });
+    }
+    Run("connect4 random playouts", [&]() { return Connect4Playouts(num_playouts, seed); });
+    for (rlop::Int num_snakes : { 1, 4 }) {
+        Run("snake random playouts with " + std::to_string(num_snakes) + " snakes", [&]() {
+            return SnakePlayouts(num_playouts / 100, num_snakes, seed);
+        });
+    }
+    for (int64_t num_rollout_playouts : { 1, 16 }) {
+        Run("snake rollouts with " + std::to_string(num_rollout_playouts) + " playouts per leaf", [&]() {
+            return SnakeRollouts(num_playouts / 1000, num_rollout_playouts, 200, seed);
+        });
+    }
+    return 0;
+}
\ No newline at end of file